@@ -0,0 +1,140 @@
+/*
+    Module: arena.c -- stack allocation for the recursive algorithms
+
+    The unate recursive paradigm (tautology(), complement(), simplify(),
+    primes_consensus(), sccc()) allocates a cube list and a few scratch
+    cubes at each node and frees them when the node returns, so the
+    blocks live and die in stack order.  Each thread has an arena of
+    large chunks from which arena_alloc() hands out blocks by bumping a
+    pointer; arena_free() gives back the block on top of the stack and
+    every block below it which has already been freed.
+
+    A block freed out of order, or by another thread (the cofactor handed
+    to a task of the pool), is only marked; the thread which owns it pops
+    it, at the latest when it frees the block below.  A block which is
+    never freed keeps the blocks above it from being reused, but costs no
+    more than the leak it already was.
+*/
+
+#include <atomic>
+#include "espresso.h"
+
+#define ARENA_CHUNK	(256 * 1024)	/* bytes in an ordinary chunk */
+#define ARENA_ALIGN	16
+
+struct arena_block {
+    struct arena *owner;
+    struct arena_block *below;		/* the block under this one */
+    std::atomic<bool> freed;
+};
+
+struct arena_chunk {
+    struct arena_chunk *prev;		/* the chunk under this one */
+    char *top;				/* first free byte */
+    char *end;
+};
+
+struct arena {
+    struct arena_chunk *chunk;		/* current chunk */
+    struct arena_chunk *spare;		/* an empty chunk kept for reuse */
+    struct arena_block *last;		/* the block on top */
+};
+
+#define BLOCK_HEADER \
+    ((sizeof(struct arena_block) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+#define CHUNK_HEADER \
+    ((sizeof(struct arena_chunk) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+#define CHUNK_BASE(c)	((char *) (c) + CHUNK_HEADER)
+
+static THREAD_LOCAL struct arena *arena_current = NULL;
+
+static struct arena_chunk *chunk_new(size_t nbytes, struct arena_chunk *prev)
+{
+    struct arena_chunk *c;
+
+    c = (struct arena_chunk *) new char[CHUNK_HEADER + nbytes];
+    c->prev = prev;
+    c->top = CHUNK_BASE(c);
+    c->end = c->top + nbytes;
+    return c;
+}
+
+static void chunk_free(struct arena_chunk *c)
+{
+    delete [] (char *) c;
+}
+
+/* arena_pop -- give back the freed blocks on top of the stack of "a" */
+static void arena_pop(struct arena *a)
+{
+    struct arena_block *b;
+    struct arena_chunk *c;
+
+    while ((b = a->last) != NULL && b->freed.load(std::memory_order_acquire)) {
+	a->last = b->below;
+	c = a->chunk;
+	c->top = (char *) b;
+	if (c->top == CHUNK_BASE(c) && c->prev != NULL) {
+	    /* the chunk is empty: keep the larger of it and the spare */
+	    a->chunk = c->prev;
+	    if (a->spare == NULL) {
+		a->spare = c;
+	    } else if (a->spare->end - CHUNK_BASE(a->spare) < c->end - CHUNK_BASE(c)) {
+		chunk_free(a->spare);
+		a->spare = c;
+	    } else {
+		chunk_free(c);
+	    }
+	}
+    }
+}
+
+/* arena_alloc -- a block of "nbytes" bytes from the arena of this thread */
+void *arena_alloc(size_t nbytes)
+{
+    struct arena *a = arena_current;
+    struct arena_block *b;
+    struct arena_chunk *c;
+    size_t need;
+
+    if (a == NULL) {
+	a = arena_current = new struct arena;
+	a->chunk = chunk_new(ARENA_CHUNK, (struct arena_chunk *) NULL);
+	a->spare = NULL;
+	a->last = NULL;
+    }
+    arena_pop(a);
+
+    need = BLOCK_HEADER + ((nbytes + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1));
+    c = a->chunk;
+    if ((size_t) (c->end - c->top) < need) {
+	if (a->spare != NULL && (size_t) (a->spare->end - a->spare->top) >= need) {
+	    c = a->spare;
+	    a->spare = NULL;
+	    c->prev = a->chunk;
+	} else {
+	    c = chunk_new(std::max(need, (size_t) ARENA_CHUNK), a->chunk);
+	}
+	a->chunk = c;
+    }
+
+    b = (struct arena_block *) c->top;
+    c->top += need;
+    b->owner = a;
+    b->below = a->last;
+    b->freed.store(FALSE, std::memory_order_relaxed);
+    a->last = b;
+    return (char *) b + BLOCK_HEADER;
+}
+
+/* arena_free -- free a block from arena_alloc() (on any thread) */
+void arena_free(void *p)
+{
+    struct arena_block *b = (struct arena_block *) ((char *) p - BLOCK_HEADER);
+    struct arena *a = b->owner;		/* b may be reused once freed */
+
+    b->freed.store(TRUE, std::memory_order_release);
+    if (a == arena_current) {
+	arena_pop(a);
+    }
+}
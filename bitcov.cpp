@@ -0,0 +1,1168 @@
+/*
+    Module: bitcov.c -- the covering search on a bit matrix
+
+    sm_mincov() works on the linked sparse matrix of sparse.h: each branch
+    of the search copies the matrix with sm_dup(), and the dominance tests
+    walk the lists of rows and columns element by element.  The search
+    below is the same search (the same reductions, bounds and choice of
+    column, hence the same cover after the same number of nodes) on a bit
+    matrix: each row is a bit vector over the columns and each column a
+    bit vector over the rows.  The columns which contain a column are the
+    "and" of its rows, and the rows which contain a row the "and" of its
+    columns, a few words at a time.
+
+    The bit vectors stay put during the search; a row or column is
+    deleted by clearing its bit in row_alive or col_alive and adjusting
+    the lengths of what crosses it.  Each change (and each column pushed
+    on the stack of selected columns) goes to an undo log, and a node of
+    the search undoes its changes before it returns, so both branches of
+    a split run on the same matrix, one after the other.  Only a task of
+    the parallel search gets a copy.
+
+    Rows and columns are numbered 0..nr-1 and 0..nc-1 in the order of
+    their numbers in the sparse matrix, so every loop meets them in the
+    same order as sm_foreach_row() and sm_foreach_col().
+*/
+
+#include <cstring>
+#include "espresso.h"
+#include "mincov_int.h"
+
+typedef unsigned long long bm_word;
+#define BM_BITS		64
+#define BM_WORDS(n)	(((n) + BM_BITS - 1) / BM_BITS)
+#define BM_IN(v, i)	(((v)[(i) / BM_BITS] >> ((i) % BM_BITS)) & 1)
+#define BM_SET(v, i)	((v)[(i) / BM_BITS] |= (bm_word) 1 << ((i) % BM_BITS))
+#define BM_CLR(v, i)	((v)[(i) / BM_BITS] &= ~((bm_word) 1 << ((i) % BM_BITS)))
+
+/* the changes in the undo log */
+#define BM_DELROW	0	/* row deleted, lengths of its columns adjusted */
+#define BM_DELCOL	1	/* column deleted, lengths of its rows adjusted */
+#define BM_HIDEROW	2	/* row deleted, no column affected */
+#define BM_HIDECOL	3	/* column deleted, no row affected */
+#define BM_INSERT	4	/* element added */
+#define BM_SELECT	5	/* column pushed on the selection */
+
+struct bm_undo {
+    int what;
+    int row, col;
+};
+
+typedef struct bm_matrix_struct bm_matrix;
+struct bm_matrix_struct {
+    int nr, nc;			/* rows and columns, deleted or not */
+    int rwords, cwords;		/* words in a column, in a row */
+    bm_word *rows;		/* row i: cwords words from BM_ROW(A, i) */
+    bm_word *cols;		/* column j: rwords words from BM_COL(A, j) */
+    bm_word *row_alive;		/* the rows not deleted */
+    bm_word *col_alive;		/* the columns not deleted */
+    int *row_len, *col_len;	/* elements in the rows and columns left */
+    int nrows, ncols;		/* rows and columns left */
+
+    int *col_num;		/* number of each column in the sparse matrix */
+    int *col_index;		/* index of each column number */
+    int *weight;		/* weight of the column numbers (or nullptr) */
+    int *col_weight;		/* weight of each column */
+    bm_matrix *origin;		/* the matrix which owns the four above */
+
+    int *sel;			/* the selected columns ... */
+    int *sel_cost;		/* ... and the cost of the first k of them */
+    int nsel;
+
+    struct bm_undo *log;
+    int log_n, log_size;
+
+    bm_word *rtemp;		/* scratch: 3 sets of rows */
+    bm_word *indep;		/* the rows of the independent set */
+    bm_word *ctemp;		/* scratch: a set of columns */
+    int *itemp;			/* scratch: one int per row */
+};
+
+#define BM_ROW(A, i)	((A)->rows + (size_t) (i) * (A)->cwords)
+#define BM_COL(A, j)	((A)->cols + (size_t) (j) * (A)->rwords)
+
+/* cost of the columns selected since the 'base'th */
+#define BM_COST(A, base) ((A)->sel_cost[(A)->nsel] - (A)->sel_cost[base])
+
+#define bm_foreach(v, mask, n, i) \
+    for(i = bm_next(v, mask, n, 0); i >= 0; i = bm_next(v, mask, n, i + 1))
+#define bm_foreach_row(A, i) \
+    bm_foreach(A->row_alive, A->row_alive, A->rwords, i)
+#define bm_foreach_col(A, j) \
+    bm_foreach(A->col_alive, A->col_alive, A->cwords, j)
+#define bm_foreach_row_element(A, i, j) \
+    bm_foreach(BM_ROW(A, i), A->col_alive, A->cwords, j)
+#define bm_foreach_col_element(A, j, i) \
+    bm_foreach(BM_COL(A, j), A->row_alive, A->rwords, i)
+
+struct bm_task {
+    bm_matrix *A;
+    int base, lb, bound, depth;
+    stats_t stats;
+    struct mincov_search search;	/* for a block of a partition */
+    solution_t *best;
+};
+
+static solution_t *bm_mincov(bm_matrix * A, int base, int lb, int bound, int depth, stats_t * stats);
+
+
+/* bm_next -- first element >= i of (v & mask), -1 if none */
+static int
+bm_next(bm_word * v, bm_word * mask, int n, int i)
+{
+    int w = i / BM_BITS;
+    bm_word x;
+
+    if (w >= n) {
+	return -1;
+    }
+    x = v[w] & mask[w] & (~(bm_word) 0 << (i % BM_BITS));
+    while (x == 0) {
+	if (++w >= n) {
+	    return -1;
+	}
+	x = v[w] & mask[w];
+    }
+    return w * BM_BITS + __builtin_ctzll(x);
+}
+
+/* bm_count -- number of elements of (v & mask) */
+static int
+bm_count(bm_word * v, bm_word * mask, int n)
+{
+    int w, count = 0;
+
+    for(w = 0; w < n; w++) {
+	count += __builtin_popcountll(v[w] & mask[w]);
+    }
+    return count;
+}
+
+static void
+bm_scratch(bm_matrix * A)
+{
+    A->log_size = 256;
+    A->log_n = 0;
+    A->log = new struct bm_undo[A->log_size];
+    A->rtemp = new bm_word[3 * A->rwords + 1];
+    A->indep = new bm_word[A->rwords + 1];
+    A->ctemp = new bm_word[A->cwords + 1];
+    A->itemp = new int[A->nr + 1];
+}
+
+/* bm_new -- the bit matrix of 'M' */
+static bm_matrix *
+bm_new(sm_matrix * M, int * weight)
+{
+    bm_matrix *A;
+    sm_row *prow;
+    sm_col *pcol;
+    sm_element *p;
+    int i, j;
+
+    A = new bm_matrix;
+    A->nr = A->nrows = M->nrows;
+    A->nc = A->ncols = M->ncols;
+    A->rwords = BM_WORDS(A->nr);
+    A->cwords = BM_WORDS(A->nc);
+    A->rows = new bm_word[(size_t) A->nr * A->cwords + 1]();
+    A->cols = new bm_word[(size_t) A->nc * A->rwords + 1]();
+    A->row_alive = new bm_word[A->rwords + 1]();
+    A->col_alive = new bm_word[A->cwords + 1]();
+    A->row_len = new int[A->nr + 1];
+    A->col_len = new int[A->nc + 1];
+
+    A->col_num = new int[A->nc + 1];
+    A->col_index = new int[M->cols_size + 1];
+    A->weight = weight;
+    A->col_weight = new int[A->nc + 1];
+    A->origin = nullptr;
+
+    A->sel = new int[A->nc + 1];
+    A->sel_cost = new int[A->nc + 2];
+    A->sel_cost[0] = 0;
+    A->nsel = 0;
+    bm_scratch(A);
+
+    j = 0;
+    sm_foreach_col(M, pcol) {
+	A->col_num[j] = pcol->col_num;
+	A->col_index[pcol->col_num] = j;
+	A->col_weight[j] = WEIGHT(weight, pcol->col_num);
+	A->col_len[j] = pcol->length;
+	BM_SET(A->col_alive, j);
+	j++;
+    }
+    i = 0;
+    sm_foreach_row(M, prow) {
+	sm_foreach_row_element(prow, p) {
+	    j = A->col_index[p->col_num];
+	    BM_SET(BM_ROW(A, i), j);
+	    BM_SET(BM_COL(A, j), i);
+	}
+	A->row_len[i] = prow->length;
+	BM_SET(A->row_alive, i);
+	i++;
+    }
+    return A;
+}
+
+/* bm_dup -- a copy of 'A' for a task, with an empty undo log */
+static bm_matrix *
+bm_dup(bm_matrix * A)
+{
+    bm_matrix *B;
+
+    B = new bm_matrix;
+    *B = *A;
+    B->origin = A->origin != nullptr ? A->origin : A;
+    B->rows = new bm_word[(size_t) A->nr * A->cwords + 1];
+    (void) memcpy(B->rows, A->rows, (size_t) A->nr * A->cwords * sizeof(bm_word));
+    B->cols = new bm_word[(size_t) A->nc * A->rwords + 1];
+    (void) memcpy(B->cols, A->cols, (size_t) A->nc * A->rwords * sizeof(bm_word));
+    B->row_alive = new bm_word[A->rwords + 1];
+    (void) memcpy(B->row_alive, A->row_alive, A->rwords * sizeof(bm_word));
+    B->col_alive = new bm_word[A->cwords + 1];
+    (void) memcpy(B->col_alive, A->col_alive, A->cwords * sizeof(bm_word));
+    B->row_len = new int[A->nr + 1];
+    (void) memcpy(B->row_len, A->row_len, A->nr * sizeof(int));
+    B->col_len = new int[A->nc + 1];
+    (void) memcpy(B->col_len, A->col_len, A->nc * sizeof(int));
+    B->sel = new int[A->nc + 1];
+    (void) memcpy(B->sel, A->sel, A->nsel * sizeof(int));
+    B->sel_cost = new int[A->nc + 2];
+    (void) memcpy(B->sel_cost, A->sel_cost, (A->nsel + 1) * sizeof(int));
+    bm_scratch(B);
+    return B;
+}
+
+static void
+bm_free(bm_matrix * A)
+{
+    delete [] A->rows;
+    delete [] A->cols;
+    delete [] A->row_alive;
+    delete [] A->col_alive;
+    delete [] A->row_len;
+    delete [] A->col_len;
+    if (A->origin == nullptr) {
+	delete [] A->col_num;
+	delete [] A->col_index;
+	delete [] A->col_weight;
+    }
+    delete [] A->sel;
+    delete [] A->sel_cost;
+    delete [] A->log;
+    delete [] A->rtemp;
+    delete [] A->indep;
+    delete [] A->ctemp;
+    delete [] A->itemp;
+    delete A;
+}
+
+
+/*
+ *  Changing the matrix
+ */
+
+static void
+bm_log(bm_matrix * A, int what, int row, int col)
+{
+    struct bm_undo *log;
+
+    if (A->log_n == A->log_size) {
+	log = new struct bm_undo[2 * A->log_size];
+	(void) memcpy(log, A->log, A->log_n * sizeof(struct bm_undo));
+	delete [] A->log;
+	A->log = log;
+	A->log_size *= 2;
+    }
+    A->log[A->log_n].what = what;
+    A->log[A->log_n].row = row;
+    A->log[A->log_n].col = col;
+    A->log_n++;
+}
+
+static void
+bm_hiderow(bm_matrix * A, int i)
+{
+    BM_CLR(A->row_alive, i);
+    A->nrows--;
+    bm_log(A, BM_HIDEROW, i, 0);
+}
+
+static void
+bm_hidecol(bm_matrix * A, int j)
+{
+    BM_CLR(A->col_alive, j);
+    A->ncols--;
+    bm_log(A, BM_HIDECOL, 0, j);
+}
+
+/* bm_delrow -- delete row 'i', and the columns left empty (as sm_delrow) */
+static void
+bm_delrow(bm_matrix * A, int i)
+{
+    int j;
+
+    if (! BM_IN(A->row_alive, i)) {
+	return;
+    }
+    BM_CLR(A->row_alive, i);
+    A->nrows--;
+    bm_log(A, BM_DELROW, i, 0);
+    bm_foreach_row_element(A, i, j) {
+	if (--A->col_len[j] == 0) {
+	    bm_hidecol(A, j);
+	}
+    }
+}
+
+/* bm_delcol -- delete column 'j', and the rows left empty (as sm_delcol) */
+static void
+bm_delcol(bm_matrix * A, int j)
+{
+    int i;
+
+    if (! BM_IN(A->col_alive, j)) {
+	return;
+    }
+    BM_CLR(A->col_alive, j);
+    A->ncols--;
+    bm_log(A, BM_DELCOL, 0, j);
+    bm_foreach_col_element(A, j, i) {
+	if (--A->row_len[i] == 0) {
+	    bm_hiderow(A, i);
+	}
+    }
+}
+
+/* bm_insert -- add the element (i, j) of two rows and columns left */
+static void
+bm_insert(bm_matrix * A, int i, int j)
+{
+    if (! BM_IN(BM_ROW(A, i), j)) {
+	BM_SET(BM_ROW(A, i), j);
+	BM_SET(BM_COL(A, j), i);
+	A->row_len[i]++;
+	A->col_len[j]++;
+	bm_log(A, BM_INSERT, i, j);
+    }
+}
+
+/* bm_hide -- delete the rows and columns of a block of the matrix */
+static void
+bm_hide(bm_matrix * A, bm_word * rows, bm_word * cols)
+{
+    int i, j;
+
+    bm_foreach(rows, A->row_alive, A->rwords, i) {
+	bm_hiderow(A, i);
+    }
+    bm_foreach(cols, A->col_alive, A->cwords, j) {
+	bm_hidecol(A, j);
+    }
+}
+
+/* bm_select -- push column 'j' on the selected columns */
+static void
+bm_select(bm_matrix * A, int j)
+{
+    A->sel[A->nsel] = j;
+    A->sel_cost[A->nsel + 1] = A->sel_cost[A->nsel] + A->col_weight[j];
+    A->nsel++;
+    bm_log(A, BM_SELECT, 0, j);
+}
+
+/* bm_accept -- select column 'j' and delete the rows it covers */
+static void
+bm_accept(bm_matrix * A, int j)
+{
+    int i;
+
+    bm_select(A, j);
+    bm_foreach_col_element(A, j, i) {
+	bm_delrow(A, i);
+    }
+}
+
+/* bm_undo -- take back the changes made since the log had 'mark' entries */
+static void
+bm_undo(bm_matrix * A, int mark)
+{
+    struct bm_undo *u;
+    int i, j;
+
+    while (A->log_n > mark) {
+	u = &A->log[--A->log_n];
+	switch (u->what) {
+	case BM_DELROW:
+	    BM_SET(A->row_alive, u->row);
+	    A->nrows++;
+	    bm_foreach_row_element(A, u->row, j) {
+		A->col_len[j]++;
+	    }
+	    break;
+	case BM_DELCOL:
+	    BM_SET(A->col_alive, u->col);
+	    A->ncols++;
+	    bm_foreach_col_element(A, u->col, i) {
+		A->row_len[i]++;
+	    }
+	    break;
+	case BM_HIDEROW:
+	    BM_SET(A->row_alive, u->row);
+	    A->nrows++;
+	    break;
+	case BM_HIDECOL:
+	    BM_SET(A->col_alive, u->col);
+	    A->ncols++;
+	    break;
+	case BM_INSERT:
+	    BM_CLR(BM_ROW(A, u->row), u->col);
+	    BM_CLR(BM_COL(A, u->col), u->row);
+	    A->row_len[u->row]--;
+	    A->col_len[u->col]--;
+	    break;
+	case BM_SELECT:
+	    A->nsel--;
+	    break;
+	}
+    }
+}
+
+/* bm_solution -- the columns selected since the 'base'th, as a solution */
+static solution_t *
+bm_solution(bm_matrix * A, int base)
+{
+    solution_t *sol;
+    int k;
+
+    sol = solution_alloc();
+    for(k = base; k < A->nsel; k++) {
+	solution_add(sol, A->weight, A->col_num[A->sel[k]]);
+    }
+    return sol;
+}
+
+
+/*
+ *  The reductions (see dominate.c, gimpel.c, indep.c and part.c)
+ */
+
+/* bm_row_dominance -- delete the rows which contain another row */
+static int
+bm_row_dominance(bm_matrix * A)
+{
+    bm_word *r = A->rtemp;
+    bm_word *col;
+    int i, i1, j, w, rowcnt;
+
+    rowcnt = A->nrows;
+    bm_foreach_row(A, i) {
+	/* the rows with all the columns of row i */
+	for(w = 0; w < A->rwords; w++) {
+	    r[w] = A->row_alive[w];
+	}
+	bm_foreach_row_element(A, i, j) {
+	    col = BM_COL(A, j);
+	    for(w = 0; w < A->rwords; w++) {
+		r[w] &= col[w];
+	    }
+	}
+	bm_foreach(r, A->row_alive, A->rwords, i1) {
+	    if (A->row_len[i1] > A->row_len[i] ||
+		    (A->row_len[i1] == A->row_len[i] && i1 > i)) {
+		bm_delrow(A, i1);
+	    }
+	}
+    }
+    return rowcnt - A->nrows;
+}
+
+/* bm_col_dominance -- delete the columns contained in a cheaper column */
+static int
+bm_col_dominance(bm_matrix * A)
+{
+    bm_word *c = A->ctemp;
+    bm_word *row;
+    int i, j, j1, w, colcnt;
+
+    colcnt = A->ncols;
+    bm_foreach_col(A, j) {
+	/* the columns with all the rows of column j */
+	for(w = 0; w < A->cwords; w++) {
+	    c[w] = A->col_alive[w];
+	}
+	bm_foreach_col_element(A, j, i) {
+	    row = BM_ROW(A, i);
+	    for(w = 0; w < A->cwords; w++) {
+		c[w] &= row[w];
+	    }
+	}
+	bm_foreach(c, A->col_alive, A->cwords, j1) {
+	    if (A->weight != nullptr && A->col_weight[j1] > A->col_weight[j])
+		continue;
+	    if (A->col_len[j1] > A->col_len[j] ||
+		    (A->col_len[j1] == A->col_len[j] && j1 > j)) {
+		bm_delcol(A, j);
+		break;
+	    }
+	}
+    }
+    return colcnt - A->ncols;
+}
+
+/* bm_select_essential -- as select_essential() in mincov.c */
+static void
+bm_select_essential(bm_matrix * A, int base, int bound)
+{
+    bm_word *essen = A->ctemp;
+    int i, j, w, delcols, delrows, essen_count;
+
+    do {
+	/*  Check for dominated columns  */
+	delcols = bm_col_dominance(A);
+
+	/*  Find the rows with only 1 element (the essentials) */
+	for(w = 0; w < A->cwords; w++) {
+	    essen[w] = 0;
+	}
+	bm_foreach_row(A, i) {
+	    if (A->row_len[i] == 1) {
+		BM_SET(essen, bm_next(BM_ROW(A, i), A->col_alive, A->cwords, 0));
+	    }
+	}
+
+	/* Select all of the elements */
+	essen_count = 0;
+	bm_foreach(essen, A->col_alive, A->cwords, j) {
+	    bm_accept(A, j);
+	    essen_count++;
+	    /* Make sure solution still looks good */
+	    if (BM_COST(A, base) >= bound) {
+		return;
+	    }
+	}
+
+	/*  Check for dominated rows  */
+	delrows = bm_row_dominance(A);
+
+    } while (delcols > 0 || delrows > 0 || essen_count > 0);
+}
+
+/* bm_gimpel_reduce -- as gimpel_reduce() in gimpel.c */
+static int
+bm_gimpel_reduce(bm_matrix * A, int base, int lb, int bound, int depth, stats_t * stats, solution_t ** best)
+{
+    sm_row *save_sec;
+    int i, j, t, c1 = -1, c2 = -1, primary, secondary;
+
+    bm_foreach_row(A, i) {
+	if (A->row_len[i] == 2) {
+	    c1 = bm_next(BM_ROW(A, i), A->col_alive, A->cwords, 0);
+	    c2 = bm_next(BM_ROW(A, i), A->col_alive, A->cwords, c1 + 1);
+	    if (A->col_len[c1] == 2) {
+		break;
+	    } else if (A->col_len[c2] == 2) {
+		j = c1;
+		c1 = c2;
+		c2 = j;
+		break;
+	    }
+	}
+    }
+    if (i < 0) {
+	return 0;
+    }
+    primary = i;
+    secondary = bm_next(BM_COL(A, c1), A->row_alive, A->rwords, 0);
+    if (secondary == primary) {
+	secondary = bm_next(BM_COL(A, c1), A->row_alive, A->rwords, primary + 1);
+    }
+
+    save_sec = sm_row_alloc();
+    bm_foreach_row_element(A, secondary, j) {
+	if (j != c1) {
+	    (void) sm_row_insert(save_sec, A->col_num[j]);
+	}
+    }
+
+    /* merge rows S1 and T */
+    bm_foreach_col_element(A, c2, t) {
+	if (t != primary) {
+	    bm_foreach_row_element(A, secondary, j) {
+		if (j != c1) {
+		    bm_insert(A, t, j);
+		}
+	    }
+	}
+    }
+
+    bm_delcol(A, c1);
+    bm_delcol(A, c2);
+    bm_delrow(A, primary);
+    bm_delrow(A, secondary);
+
+    stats->gimpel_count++;
+    stats->gimpel++;
+    *best = bm_mincov(A, base, lb-1, bound-1, depth, stats);
+    stats->gimpel--;
+
+    if (*best != nullptr) {
+	/* is secondary row covered ? */
+	if (sm_row_intersects(save_sec, (*best)->row)) {
+	    /* yes, actually select c2 */
+	    solution_add(*best, A->weight, A->col_num[c2]);
+	} else {
+	    solution_add(*best, A->weight, A->col_num[c1]);
+	}
+    }
+
+    sm_row_free(save_sec);
+    return 1;
+}
+
+/* bm_neighbours -- the rows left which share a column with row 'i' */
+static void
+bm_neighbours(bm_matrix * A, int i, bm_word * r)
+{
+    bm_word *col;
+    int j, w;
+
+    for(w = 0; w < A->rwords; w++) {
+	r[w] = 0;
+    }
+    bm_foreach_row_element(A, i, j) {
+	col = BM_COL(A, j);
+	for(w = 0; w < A->rwords; w++) {
+	    r[w] |= col[w];
+	}
+    }
+}
+
+/*
+ *  bm_independent_set -- as sm_maximal_independent_set() in indep.c
+ *
+ *  Puts the rows in 'indep' and returns the cost.  Instead of building
+ *  the row intersection matrix, the number of rows left which intersect
+ *  each row is kept in itemp and decreased as rows are taken away.
+ */
+static int
+bm_independent_set(bm_matrix * A, bm_word * indep)
+{
+    bm_word *left = A->rtemp;
+    bm_word *gone = A->rtemp + A->rwords;
+    bm_word *r = A->rtemp + 2 * A->rwords;
+    int *len = A->itemp;
+    int i, j, x, w, best_row, least_weight, cost;
+
+    for(w = 0; w < A->rwords; w++) {
+	left[w] = A->row_alive[w];
+	indep[w] = 0;
+    }
+    bm_foreach_row(A, i) {
+	bm_neighbours(A, i, r);
+	len[i] = bm_count(r, left, A->rwords);
+    }
+
+    cost = 0;
+    while ((best_row = bm_next(left, left, A->rwords, 0)) >= 0) {
+	/*  Find the row which is disjoint from a maximum number of rows */
+	bm_foreach(left, left, A->rwords, i) {
+	    if (len[i] < len[best_row]) {
+		best_row = i;
+	    }
+	}
+
+	/* Find which element in this row has least weight */
+	if (A->weight == nullptr) {
+	    least_weight = 1;
+	} else {
+	    least_weight = -1;
+	    bm_foreach_row_element(A, best_row, j) {
+		if (least_weight < 0 || A->col_weight[j] < least_weight) {
+		    least_weight = A->col_weight[j];
+		}
+	    }
+	}
+	cost += least_weight;
+	BM_SET(indep, best_row);
+
+	/*  Discard the rows which intersect this row */
+	bm_neighbours(A, best_row, gone);
+	for(w = 0; w < A->rwords; w++) {
+	    gone[w] &= left[w];
+	    left[w] &= ~gone[w];
+	}
+	bm_foreach(gone, gone, A->rwords, x) {
+	    bm_neighbours(A, x, r);
+	    bm_foreach(r, left, A->rwords, i) {
+		len[i]--;
+	    }
+	}
+    }
+    return cost;
+}
+
+/* bm_lagrange_bound -- sm_lagrange_bound() of the bit matrix */
+static int
+bm_lagrange_bound(bm_matrix * A, int target)
+{
+    lagrange_t L;
+    int *index, i, j, k, n, lb;
+
+    L.nrows = A->nrows;
+    L.ncols = A->ncols;
+    L.start = new int[A->nrows + 1];
+    L.cost = new int[A->ncols + 1];
+    index = new int[A->nc + 1];
+    n = 0;
+    bm_foreach_col(A, j) {
+	index[j] = n;
+	L.cost[n++] = A->col_weight[j];
+    }
+    k = 0;
+    bm_foreach_row(A, i) {
+	k += A->row_len[i];
+    }
+    L.col = new int[k + 1];
+
+    n = k = 0;
+    bm_foreach_row(A, i) {
+	L.start[n++] = k;
+	bm_foreach_row_element(A, i, j) {
+	    L.col[k++] = index[j];
+	}
+    }
+    L.start[n] = k;
+
+    lb = lagrange_bound(&L, target);
+    delete [] index;
+    delete [] L.start;
+    delete [] L.col;
+    delete [] L.cost;
+    return lb;
+}
+
+/* bm_select_column -- as select_column() in mincov.c */
+static int
+bm_select_column(bm_matrix * A, bm_word * indep)
+{
+    bm_word *cols = A->ctemp;
+    bm_word *row;
+    double w, best;
+    int i, j, k, best_col;
+
+    /* Find which columns are in the independent sets */
+    for(k = 0; k < A->cwords; k++) {
+	cols[k] = 0;
+    }
+    bm_foreach(indep, A->row_alive, A->rwords, i) {
+	row = BM_ROW(A, i);
+	for(k = 0; k < A->cwords; k++) {
+	    cols[k] |= row[k];
+	}
+    }
+
+    /* Find the best column */
+    best_col = -1;
+    best = -1;
+
+    /* Consider only columns which are in some independent row */
+    bm_foreach(cols, A->col_alive, A->cwords, j) {
+	/* Compute the total 'value' of all things covered by the column */
+	w = 0.0;
+	bm_foreach_col_element(A, j, i) {
+	    w += 1.0 / ((double) A->row_len[i] - 1.0);
+	}
+
+	/* divide this by the relative cost of choosing this column */
+	w = w / (double) A->col_weight[j];
+
+	/* maximize this ratio */
+	if (w > best) {
+	    best_col = j;
+	    best = w;
+	}
+    }
+    return best_col;
+}
+
+/*
+ *  bm_block_partition -- as sm_block_partition() in part.c
+ *
+ *  Puts the rows and columns connected to the first row into 'rows' and
+ *  'cols', the others into 'rows1' and 'cols1'.
+ */
+static int
+bm_block_partition(bm_matrix * A, bm_word * rows, bm_word * cols,
+		   bm_word * rows1, bm_word * cols1)
+{
+    int *stack = A->itemp;
+    int i, i1, j, w, n;
+
+    /* Avoid the trivial case */
+    if (A->nrows == 0) {
+	return 0;
+    }
+
+    for(w = 0; w < A->rwords; w++) {
+	rows[w] = 0;
+    }
+    for(w = 0; w < A->cwords; w++) {
+	cols[w] = 0;
+    }
+    i = bm_next(A->row_alive, A->row_alive, A->rwords, 0);
+    BM_SET(rows, i);
+    stack[0] = i;
+    n = 1;
+    while (n > 0) {
+	i = stack[--n];
+	bm_foreach_row_element(A, i, j) {
+	    if (! BM_IN(cols, j)) {
+		BM_SET(cols, j);
+		bm_foreach_col_element(A, j, i1) {
+		    if (! BM_IN(rows, i1)) {
+			BM_SET(rows, i1);
+			stack[n++] = i1;
+		    }
+		}
+	    }
+	}
+    }
+
+    if (bm_count(rows, A->row_alive, A->rwords) == A->nrows) {
+	/* we found all of the rows */
+	return 0;
+    }
+    for(w = 0; w < A->rwords; w++) {
+	rows1[w] = A->row_alive[w] & ~rows[w];
+    }
+    for(w = 0; w < A->cwords; w++) {
+	cols1[w] = A->col_alive[w] & ~cols[w];
+    }
+    return 1;
+}
+
+
+/*
+ *  The search
+ */
+
+static void
+bm_run(void * arg)
+{
+    struct bm_task *t = (struct bm_task *) arg;
+
+    t->best = bm_mincov(t->A, t->base, t->lb, t->bound, t->depth, &t->stats);
+}
+
+/* bm_reject -- as mincov_reject() in mincov.c */
+static void
+bm_reject(void * arg)
+{
+    struct bm_task *t = (struct bm_task *) arg;
+
+    t->best = nullptr;
+    if (! mincov_stop(&t->stats)) {
+	bm_run(arg);
+    }
+}
+
+/* bm_branch -- as mincov_branch() in mincov.c */
+static solution_t *
+bm_branch(bm_matrix * A, int base, int pick, int lb, int bound, int depth, stats_t * stats)
+{
+    struct bm_task reject;
+    struct task_group group;
+    solution_t *best1, *best2;
+    long prefix = stats->prefix, bit;
+    int level = stats->level, mark;
+    bool spawn;
+
+    bit = level < MINCOV_LEVELS ? 1L << (MINCOV_LEVELS - 1 - level) : 0;
+    spawn = level < MINCOV_LEVELS && A->nrows >= MINCOV_SPAWN_ROWS &&
+	    ! mincov_stop(stats);
+
+    /* Assume we cannot have that column (as a task, on a copy) */
+    if (spawn) {
+	reject.A = bm_dup(A);
+	bm_delcol(reject.A, pick);
+	reject.base = base;
+	reject.lb = lb;
+	reject.bound = bound;
+	reject.depth = depth + 1;
+	mincov_fork(&reject.stats, stats);
+	reject.stats.prefix = prefix | bit;
+	reject.stats.level = level + 1;
+	reject.best = nullptr;
+	group.pending = 0;
+	pool_spawn(&group, bm_reject, (void *) &reject);
+    }
+
+    /* Assume we choose this column to be in the covering set */
+    mark = A->log_n;
+    bm_accept(A, pick);
+    stats->level = level + 1;
+    best1 = bm_mincov(A, base, lb, bound, depth+1, stats);
+    bm_undo(A, mark);
+
+    if (spawn) {
+	pool_wait(&group);
+	mincov_join(stats, &reject.stats);
+	bm_free(reject.A);
+	best2 = reject.best;
+    } else if (mincov_stop(stats) || (best1 != nullptr && best1->cost == lb)) {
+	best2 = nullptr;
+    } else {
+	if (best1 != nullptr && bound > best1->cost) {
+	    bound = best1->cost;
+	}
+	bm_delcol(A, pick);
+	stats->prefix = prefix | bit;
+	best2 = bm_mincov(A, base, lb, bound, depth+1, stats);
+	bm_undo(A, mark);
+    }
+    stats->prefix = prefix;
+    stats->level = level;
+
+    return solution_choose_best(best1, best2);
+}
+
+/* bm_blocks -- as mincov_blocks() in mincov.c; R is solved on a copy */
+static solution_t *
+bm_blocks(bm_matrix * A, bm_word * lrows, bm_word * lcols, bm_word * rrows,
+	  bm_word * rcols, int base, int bound, int depth, stats_t * stats)
+{
+    struct bm_task left, right;
+    struct task_group group;
+    solution_t *best;
+    sm_element *p;
+    int mark;
+
+    right.A = bm_dup(A);
+    bm_hide(right.A, lrows, lcols);
+    right.base = right.A->nsel;
+    right.lb = 0;
+    right.bound = bound - BM_COST(A, base);
+    right.depth = depth + 1;
+    mincov_fork(&right.stats, stats);
+    mincov_new_search(&right.stats, &right.search);
+    right.best = nullptr;
+    group.pending = 0;
+    pool_spawn(&group, bm_run, (void *) &right);
+
+    mark = A->log_n;
+    bm_hide(A, rrows, rcols);
+    left.A = A;
+    left.base = A->nsel;
+    left.lb = 0;
+    left.bound = bound - BM_COST(A, base);
+    left.depth = depth + 1;
+    mincov_fork(&left.stats, stats);
+    left.stats.component++;
+    mincov_new_search(&left.stats, &left.search);
+    bm_run((void *) &left);
+    bm_undo(A, mark);
+
+    pool_wait(&group);
+    mincov_join(stats, &left.stats);
+    mincov_join(stats, &right.stats);
+    bm_free(right.A);
+
+    best = nullptr;
+    if (left.best != nullptr && right.best != nullptr) {
+	best = bm_solution(A, base);
+	for(p = left.best->row->first_col; p != 0; p = p->next_col) {
+	    solution_add(best, A->weight, p->col_num);
+	}
+	for(p = right.best->row->first_col; p != 0; p = p->next_col) {
+	    solution_add(best, A->weight, p->col_num);
+	}
+	if (best->cost >= bound) {
+	    solution_free(best);
+	    best = nullptr;
+	} else {
+	    mincov_better(stats, best->cost);
+	}
+    }
+    if (left.best != nullptr) solution_free(left.best);
+    if (right.best != nullptr) solution_free(right.best);
+    return best;
+}
+
+/*
+ *  bm_mincov -- sm_mincov() on a bit matrix
+ *
+ *  The selected set is the columns of the selection stack from the
+ *  'base'th on.  'A' is the same on return as on entry.
+ */
+static solution_t *
+bm_mincov(bm_matrix * A, int base, int lb, int bound, int depth, stats_t * stats)
+{
+    bm_word *blocks, *lrows, *lcols, *rrows, *rcols, *swap;
+    solution_t *best, *best1, *best2;
+    sm_element *p;
+    int mark = A->log_n, m, pick, lb_new, debug, nl, nr;
+
+    /* Start out with some debugging information */
+    mincov_node(stats, depth);
+    debug = stats->debug && (depth <= stats->max_print_depth);
+
+    /* Apply row dominance, column dominance, and select essentials */
+    bound = mincov_bound(stats, bound);
+    bm_select_essential(A, base, bound);
+    if (BM_COST(A, base) >= bound) {
+	bm_undo(A, mark);
+	return nullptr;
+    }
+
+    /* See if gimpel's reduction technique applies ... */
+    if (A->weight == nullptr) {	/* hack until we fix it */
+	if (bm_gimpel_reduce(A, base, lb, bound, depth, stats, &best)) {
+	    bm_undo(A, mark);
+	    return best;
+	}
+    }
+
+    /* Determine bound from here to final solution using independent-set */
+    lb_new = std::max(BM_COST(A, base) + bm_independent_set(A, A->indep), lb);
+    pick = bm_select_column(A, A->indep);
+
+    /* Raise it with the Lagrangian bound, unless the node is bounded anyway */
+    if (depth == 0) {
+	stats->indep_bound = lb_new + stats->gimpel;
+    }
+    if (mincov_lower_bound == MINCOV_LAGRANGE && lb_new < bound && A->nrows > 0) {
+	lb_new = mincov_lagrange(stats, lb_new,
+	    BM_COST(A, base) + bm_lagrange_bound(A, bound - BM_COST(A, base)));
+    }
+
+    if (depth == 0) {
+	stats->lower_bound = lb_new + stats->gimpel;
+    }
+    bound = mincov_bound(stats, bound);
+
+    if (debug) {
+        (void) printf("ABSMIN[%2d]%s", depth, stats->component ? "*" : " ");
+        (void) printf(" %3dx%3d sel=%3d bnd=%3d lb=%3d ",
+            A->nrows, A->ncols, BM_COST(A, base) + stats->gimpel,
+	    bound + stats->gimpel, lb_new + stats->gimpel);
+    }
+
+    blocks = new bm_word[2 * (A->rwords + A->cwords) + 1];
+    lrows = blocks;
+    lcols = lrows + A->rwords;
+    rrows = lcols + A->cwords;
+    rcols = rrows + A->rwords;
+
+    /* Check for bounding based on no better solution possible */
+    if (lb_new >= bound) {
+	if (debug) (void) printf("bounded\n");
+	best = nullptr;
+
+
+    /* Check for new best solution */
+    } else if (A->nrows == 0) {
+	best = bm_solution(A, base);
+	mincov_better(stats, best->cost);
+	if (debug) (void) printf("BEST\n");
+	if (stats->debug && stats->component == 0) {
+            (void) printf("new 'best' solution %d at level %d\n",
+		best->cost + stats->gimpel, depth);
+        }
+
+
+    /* Check for a partition of the problem */
+    } else if (bm_block_partition(A, lrows, lcols, rrows, rcols)) {
+	/* Make L the smaller problem */
+	nl = bm_count(lcols, lcols, A->cwords);
+	nr = bm_count(rcols, rcols, A->cwords);
+	if (nl > nr) {
+	    swap = lrows; lrows = rrows; rrows = swap;
+	    swap = lcols; lcols = rcols; rcols = swap;
+	}
+	if (debug) (void) printf("comp %d %d\n",
+	    bm_count(lrows, lrows, A->rwords), bm_count(rrows, rrows, A->rwords));
+	stats->comp_count++;
+
+	if (stats->search != nullptr) {
+	    best = bm_blocks(A, lrows, lcols, rrows, rcols, base, bound, depth, stats);
+
+	} else {
+	    /* Solve problem for L */
+	    m = A->log_n;
+	    bm_hide(A, rrows, rcols);
+	    stats->component++;
+	    best1 = bm_mincov(A, A->nsel, 0, bound-BM_COST(A, base), depth+1, stats);
+	    stats->component--;
+	    bm_undo(A, m);
+
+	    /* Add best solution to the selected set */
+	    if (best1 == nullptr) {
+		best = nullptr;
+	    } else {
+		for(p = best1->row->first_col; p != 0; p = p->next_col) {
+		    bm_select(A, A->col_index[p->col_num]);
+		}
+		solution_free(best1);
+
+		/* recur for the remaining block */
+		bm_hide(A, lrows, lcols);
+		best = bm_mincov(A, base, lb_new, bound, depth+1, stats);
+	    }
+	}
+
+    /* We've tried as hard as possible, but now we must split and recur */
+    } else if (stats->search != nullptr) {
+	best = bm_branch(A, base, pick, lb_new, bound, depth, stats);
+
+    } else {
+	if (debug) (void) printf("pick=%d\n", A->col_num[pick]);
+
+        /* Assume we choose this column to be in the covering set */
+	m = A->log_n;
+	bm_accept(A, pick);
+        best1 = bm_mincov(A, base, lb_new, bound, depth+1, stats);
+	bm_undo(A, m);
+
+	/* Update the upper bound if we found a better solution */
+	if (best1 != nullptr && bound > best1->cost) {
+	    bound = best1->cost;
+	}
+
+	/* See if this is a heuristic covering (no branching), or out of budget */
+	/* Check for reaching lower bound -- if so, don't actually branch */
+	if (mincov_stop(stats) || (best1 != nullptr && best1->cost == lb_new)) {
+	    best = best1;
+
+	} else {
+	    /* Now assume we cannot have that column */
+	    bm_delcol(A, pick);
+	    best2 = bm_mincov(A, base, lb_new, bound, depth+1, stats);
+	    bm_undo(A, m);
+
+	    best = solution_choose_best(best1, best2);
+	}
+    }
+
+    delete [] blocks;
+    bm_undo(A, mark);
+    return best;
+}
+
+/*
+ *  bm_minimum_cover -- the search of sm_minimum_cover() on a bit matrix
+ */
+solution_t *
+bm_minimum_cover(sm_matrix * M, int * weight, int bound, stats_t * stats)
+{
+    bm_matrix *A;
+    solution_t *best;
+
+    A = bm_new(M, weight);
+    best = bm_mincov(A, 0, 0, bound, 0, stats);
+    bm_free(A);
+    return best;
+}
@@ -14,14 +14,14 @@ void print_bw();
 static void free_stack();
 static void clear();
 
-static int white_head, white_tail;
-static int black_head, black_tail;
-static int forward_link, backward_link;
-static int *forward, *backward;
+static THREAD_LOCAL int white_head, white_tail;
+static THREAD_LOCAL int black_head, black_tail;
+static THREAD_LOCAL int forward_link, backward_link;
+static THREAD_LOCAL int *forward, *backward;
 
-static int *stack_head, *stack_tail, stack_p;
+static THREAD_LOCAL int *stack_head, *stack_tail, stack_p;
 
-static pcover BB;
+static THREAD_LOCAL pcover BB;
 
 static void
 alloc_list(int size)
@@ -181,7 +181,7 @@ setup_bw(pcover R,pcube c)
 	int i;
 	pcube b,r;
     	int w, last;
-	unsigned int x;
+	set_word x;
 
 	/* Allocate memory */
 	alloc_list(size);
@@ -268,11 +268,11 @@ split_list(pcover R, int v)
 }
 
 /* Data Structures for ordering variables in ess_test_and_reduction */
-static int variable_count; /* Number of variables currently in the list */
-static int *variable_forward_chain; /* Next */
-static int *variable_backward_chain; /* Previous */
-static int variable_head; /* first element in the list */
-static int variable_tail; /* last element in the list */
+static THREAD_LOCAL int variable_count; /* Number of variables currently in the list */
+static THREAD_LOCAL int *variable_forward_chain; /* Next */
+static THREAD_LOCAL int *variable_backward_chain; /* Previous */
+static THREAD_LOCAL int variable_head; /* first element in the list */
+static THREAD_LOCAL int variable_tail; /* last element in the list */
 
 void
 variable_list_alloc(int size)
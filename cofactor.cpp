@@ -38,11 +38,11 @@ pcube *cofactor(pcube* T, pcube c)
     listlen = static_cast<int>(CUBELISTSIZE(T) + 5);
 
     /* Allocate a new list of cube pointers (max size is previous size) */
-    Tc_save = Tc = new pcube[listlen];
+    Tc_save = Tc = new_cubelist(listlen);
 
     /* pass on which variables have been cofactored against */
-    *Tc++ = set_or(new_cube(), T[0], set_diff(temp, cube.fullset, c));
-    Tc++;
+    (void) set_or(Tc[0], T[0], set_diff(temp, cube.fullset, c));
+    Tc += 2;
 
     /* Loop for each cube in the list, determine suitability, and save */
     for(T1 = T+2; (p = *T1++) != NULL; ) {
@@ -51,12 +51,33 @@ pcube *cofactor(pcube* T, pcube c)
 #ifdef NO_INLINE
 	if (! cdist0(p, c)) goto false;
 #else
-    {int w,last;unsigned int x;if((last=cube.inword)!=-1)
-    {x=p[last]&c[last];if(~(x|x>>1)&cube.inmask)goto false0;for(w=1;w<last;w++)
-    {x=p[w]&c[w];if(~(x|x>>1)&DISJOINT)goto false0;}}}{int w,var,last;
-    pcube mask;for(var=cube.num_binary_vars;var<cube.num_vars;var++){
-    mask=cube.var_mask[var];last=cube.last_word[var];for(w=cube.first_word[var
-    ];w<=last;w++)if(p[w]&c[w]&mask[w])goto nextvar;goto false0;nextvar:;}}
+	if (set_vector.cdist0 != NULL) {
+	    if (! (*set_vector.cdist0)(p, c)) goto false0;
+	} else {
+	    int w, var, last;
+	    set_word x;
+	    pcube mask;
+
+	    if ((last = cube.inword) != -1) {
+		x = p[last] & c[last];
+		if (~(x | x >> 1) & cube.inmask)
+		    goto false0;
+		for(w = 1; w < last; w++) {
+		    x = p[w] & c[w];
+		    if (~(x | x >> 1) & DISJOINT)
+			goto false0;
+		}
+	    }
+	    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+		mask = cube.var_mask[var];
+		last = cube.last_word[var];
+		for(w = cube.first_word[var]; w <= last; w++)
+		    if (p[w] & c[w] & mask[w])
+			goto nextvar;
+		goto false0;
+	    nextvar:;
+	    }
+	}
 #endif
 
 	    *Tc++ = p;
@@ -86,11 +107,11 @@ pcube *scofactor(pcube * T, pcube c, int var)
     listlen = static_cast<int>(CUBELISTSIZE(T) + 5);
 
     /* Allocate a new list of cube pointers (max size is previous size) */
-    Tc_save = Tc = new pcube[listlen];
+    Tc_save = Tc = new_cubelist(listlen);
 
     /* pass on which variables have been cofactored against */
-    *Tc++ = set_or(new_cube(), T[0], set_diff(mask, cube.fullset, c));
-    Tc++;
+    (void) set_or(Tc[0], T[0], set_diff(mask, cube.fullset, c));
+    Tc += 2;
 
     /* Setup for the quick distance check */
     (void) set_and(mask, cube.var_mask[var], c);
@@ -125,12 +146,16 @@ void massive_count(pcube * T)
 
     /* Count the number of zeros in each column */
  {  int i, *cnt;
-    unsigned int val;
+    set_word val;
     pcube p, cof = T[0], full = cube.fullset;
     for(T1 = T+2; (p = *T1++) != NULL; )
 	for(i = LOOP(p); i > 0; i--)
 	    if ((val = full[i] & ~ (p[i] | cof[i]))) {
 		cnt = count + ((i-1) << LOGBPI);
+#if BPI == 64
+	    /* visit only the set bits of the wide word */
+	    do cnt[first_one(val)]++; while ((val &= val - 1) != 0);
+#else
 #if BPI == 32
 	    if (val & 0xFF000000) {
 		if (val & 0x80000000) cnt[31]++;
@@ -173,6 +198,7 @@ void massive_count(pcube * T)
 		if (val & 0x0002) cnt[ 1]++;
 		if (val & 0x0001) cnt[ 0]++;
 	    }
+#endif
 	}
  }
 
@@ -267,13 +293,29 @@ int binate_split_select(pcube * T, pcube cleft, pcube cright, int debug_flag)
 }
 
 
+/*
+    new_cubelist -- room for a cube list of "n" entries
+
+    The list and its cube T[0] (cleared) are one block of the arena of
+    this thread (see arena.c); free_cubelist() gives it back.
+*/
+pcube *new_cubelist(int n)
+{
+    pcube *T;
+
+    T = (pcube *) arena_alloc(n * sizeof(pcube) +
+			      SET_SIZE(cube.size) * sizeof(set_word));
+    T[0] = set_clear((pcube) (T + n), cube.size);
+    return T;
+}
+
+
 pcube *cube1list(pcover A)
 {
     pcube last, p, *plist, *list;
 
-    list = plist = new pcube[A->count + 3];
-    *plist++ = new_cube();
-    plist++;
+    list = plist = new_cubelist(A->count + 3);
+    plist += 2;
     foreach_set(A, last, p) {
 	*plist++ = p;
     }
@@ -287,9 +329,8 @@ pcube *cube2list(pcover A, pcover B)
 {
     pcube last, p, *plist, *list;
 
-    list = plist = new pcube[A->count + B->count + 3];
-    *plist++ = new_cube();
-    plist++;
+    list = plist = new_cubelist(A->count + B->count + 3);
+    plist += 2;
     foreach_set(A, last, p) {
 	*plist++ = p;
     }
@@ -306,10 +347,8 @@ pcube *cube3list(pcover A, pcover B, pcover C)
 {
     pcube last, p, *plist, *list;
 
-    plist = new pcube[A->count + B->count + C->count + 3];
-    list = plist;
-    *plist++ = new_cube();
-    plist++;
+    list = plist = new_cubelist(A->count + B->count + C->count + 3);
+    plist += 2;
     foreach_set(A, last, p) {
 	*plist++ = p;
     }
@@ -22,6 +22,10 @@
 #define USE_COMPL_LIFT_ONSET_COMPLEX	2
 #define NO_LIFTING			3
 
+#ifndef COMPL_CACHE_CUBES
+#define COMPL_CACHE_CUBES		4	/* smaller lists are not cached */
+#endif
+
 bool compl_special_cases(pcube * T /* will be disposed if answer is determined */, pcover * Tbar /* returned only if answer determined */);
 pcover compl_merge(
                    pcube *T1,			/* Original ON-set */
@@ -43,6 +47,53 @@ bool simp_comp_special_cases(
                              pcover *Tbar			/* returned only if answer determined */);
 bool simplify_special_cases(pcube *T /* will be disposed if answer is determined */, pcover *Tnew /* returned only if answer determined */);
 
+/*
+ *  compl_halves -- fn() of the two cofactors of T around 'best'
+ *
+ *  The two halves of a split are independent: with a pool, the right one
+ *  is handed to the pool while this thread works on the left one, and
+ *  the larger cube lists spawn again further down.  The tasks only read
+ *  the cubes of T; the cofactors, cube.temp and cdata are private to the
+ *  thread running each task.  Each half is exactly the cover the
+ *  sequential recursion computes, and compl_merge() combines them in the
+ *  same order, so the result does not depend on the number of threads.
+ */
+#define COMPL_SPAWN_CUBES	64	/* do not spawn for smaller cubelists */
+
+struct compl_task {
+    pcube *T;
+    pcover (*fn)(pcube *);		/* complement() or simplify() */
+    pcover result;
+};
+
+static void compl_run(void *arg)
+{
+    struct compl_task *task = (struct compl_task *) arg;
+
+    task->result = (*task->fn)(task->T);
+}
+
+static void compl_halves(pcover (*fn)(pcube *), pcube *T, pcube cl, pcube cr, int best, pcover *Tl, pcover *Tr)
+{
+    struct compl_task right;
+    struct task_group group;
+
+    if (pool_threads() > 1 && ! (debug & COMPL) &&
+	    CUBELISTSIZE(T) >= COMPL_SPAWN_CUBES) {
+	right.T = scofactor(T, cr, best);
+	right.fn = fn;
+	right.result = NULL;
+	group.pending = 0;
+	pool_spawn(&group, compl_run, &right);
+	*Tl = (*fn)(scofactor(T, cl, best));
+	pool_wait(&group);
+	*Tr = right.result;
+    } else {
+	*Tl = (*fn)(scofactor(T, cl, best));
+	*Tr = (*fn)(scofactor(T, cr, best));
+    }
+}
+
 
 /* complement -- compute the complement of T */
 pcover complement(pcube * T /* T will be disposed of */)
@@ -51,21 +102,32 @@ pcover complement(pcube * T /* T will be disposed of */)
     int best;
     pcover Tbar, Tl, Tr;
     int lifting;
-    static int compl_level = 0;
+    compl_key_t key;
+    bool cached;
+    static THREAD_LOCAL int compl_level = 0;
 
     if (debug & COMPL)
 	debug_print(T, "COMPLEMENT", compl_level++);
 
     if (compl_special_cases(T, &Tbar) == MAYBE) {
 
+	/* Look for the complement of this cube list in the cache (-c) */
+	cached = compl_cache_limit > 0 && CUBELISTSIZE(T) >= COMPL_CACHE_CUBES;
+	if (cached) {
+	    compl_cache_key(T, &key);
+	    if ((Tbar = compl_cache_find(&key)) != NULL) {
+		free_cubelist(T);
+		goto done;
+	    }
+	}
+
 	/* Allocate space for the partition cubes */
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 	best = binate_split_select(T, cl, cr, COMPL);
 
 	/* Complement the left and right halves */
-	Tl = complement(scofactor(T, cl, best));
-	Tr = complement(scofactor(T, cr, best));
+	compl_halves(complement, T, cl, cr, best, &Tl, &Tr);
 
 	if (Tr->count*Tl->count > (Tr->count+Tl->count)*CUBELISTSIZE(T)) {
 	    lifting = USE_COMPL_LIFT_ONSET;
@@ -74,11 +136,15 @@ pcover complement(pcube * T /* T will be disposed of */)
 	}
 	Tbar = compl_merge(T, Tl, Tr, cl, cr, best, lifting);
 
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
 	free_cubelist(T);
+	if (cached) {
+	    compl_cache_save(&key, Tbar);
+	}
     }
 
+done:
     if (debug & COMPL)
 	debug1_print(Tbar, "exit COMPLEMENT", --compl_level);
     return Tbar;
@@ -113,21 +179,18 @@ bool compl_special_cases(pcube * T /* will be disposed if answer is determined *
     }
 
     /* Check for a column of all 0's which can be factored out */
-    size_t size = SET_SIZE(NELEM(cof));
-    //std::cerr << "Size: " << size << std::endl;
-    ceil = set_copy(new unsigned int[size], cof);
-    //ceil = set_save(cof);
+    ceil = set_copy(new_scratch_cube(), cof);
     for(T1 = T+2; (p = *T1++) != NULL; ) {
 	INLINEset_or(ceil, ceil, p);
     }
     if (! setp_equal(ceil, cube.fullset)) {
 	ceil_compl = compl_cube(ceil);
 	(void) set_or(cof, cof, set_diff(ceil, cube.fullset, ceil));
-	set_free(ceil);
+	free_scratch_cube(ceil);
 	*Tbar = sf_append(complement(T), ceil_compl);
 	return TRUE;
     }
-    set_free(ceil);
+    free_scratch_cube(ceil);
 
     /* Collect column counts, determine unate variables, etc. */
     massive_count(T);
@@ -415,7 +478,7 @@ void simp_comp(pcube * T /* T will be disposed of */, pcover * Tnew, pcover * Tb
     int best;
     pcover Tl, Tr, Tlbar, Trbar;
     int lifting;
-    static int simplify_level = 0;
+    static THREAD_LOCAL int simplify_level = 0;
 
     if (debug & COMPL)
 	debug_print(T, "SIMPCOMP", simplify_level++);
@@ -423,8 +486,8 @@ void simp_comp(pcube * T /* T will be disposed of */, pcover * Tnew, pcover * Tb
     if (simp_comp_special_cases(T, Tnew, Tbar) == MAYBE) {
 
 	/* Allocate space for the partition cubes */
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 	best = binate_split_select(T, cl, cr, COMPL);
 
 	/* Complement the left and right halves */
@@ -443,8 +506,8 @@ void simp_comp(pcube * T /* T will be disposed of */, pcover * Tnew, pcover * Tb
 	    *Tnew = cubeunlist(T);
 	}
 
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
 	free_cubelist(T);
     }
 
@@ -492,15 +555,15 @@ pcover *Tbar			/* returned only if answer determined */)
     }
 
     /* Check for a column of all 0's which can be factored out */
-    ceil = set_save(cof);
+    ceil = set_copy(new_scratch_cube(), cof);
     for(T1 = T+2; (p = *T1++) != NULL; ) {
 	INLINEset_or(ceil, ceil, p);
     }
     if (! setp_equal(ceil, cube.fullset)) {
-	p = new_cube();
+	p = new_scratch_cube();
 	(void) set_diff(p, cube.fullset, ceil);
 	(void) set_or(cof, cof, p);
-	set_free(p);
+	free_scratch_cube(p);
 	simp_comp(T, Tnew, Tbar);
 
 	/* Adjust the ON-set */
@@ -511,10 +574,10 @@ pcover *Tbar			/* returned only if answer determined */)
 
 	/* Compute the new complement */
 	*Tbar = sf_append(*Tbar, compl_cube(ceil));
-	set_free(ceil);
+	free_scratch_cube(ceil);
 	return TRUE;
     }
-    set_free(ceil);
+    free_scratch_cube(ceil);
 
     /* Collect column counts, determine unate variables, etc. */
     massive_count(T);
@@ -553,7 +616,7 @@ pcover simplify(pcube * T /* T will be disposed of */)
     int best;
     pcover Tbar, Tl, Tr;
     int lifting;
-    static int simplify_level = 0;
+    static THREAD_LOCAL int simplify_level = 0;
 
     if (debug & COMPL) {
 	debug_print(T, "SIMPLIFY", simplify_level++);
@@ -562,14 +625,13 @@ pcover simplify(pcube * T /* T will be disposed of */)
     if (simplify_special_cases(T, &Tbar) == MAYBE) {
 
 	/* Allocate space for the partition cubes */
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 
 	best = binate_split_select(T, cl, cr, COMPL);
 
-	/* Complement the left and right halves */
-	Tl = simplify(scofactor(T, cl, best));
-	Tr = simplify(scofactor(T, cr, best));
+	/* Simplify the left and right halves */
+	compl_halves(simplify, T, cl, cr, best, &Tl, &Tr);
 
 	lifting = USE_COMPL_LIFT;
 	Tbar = compl_merge(T, Tl, Tr, cl, cr, best, lifting);
@@ -580,8 +642,8 @@ pcover simplify(pcube * T /* T will be disposed of */)
 	    Tbar = cubeunlist(T);
 	}
 
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
 	free_cubelist(T);
     }
 
@@ -621,25 +683,25 @@ bool simplify_special_cases(pcube *T /* will be disposed if answer is determined
     }
 
     /* Check for a column of all 0's which can be factored out */
-    ceil = set_save(cof);
+    ceil = set_copy(new_scratch_cube(), cof);
     for(T1 = T+2; (p = *T1++) != NULL; ) {
 	INLINEset_or(ceil, ceil, p);
     }
     if (! setp_equal(ceil, cube.fullset)) {
-	p = new_cube();
+	p = new_scratch_cube();
 	(void) set_diff(p, cube.fullset, ceil);
 	(void) set_or(cof, cof, p);
-	free_cube(p);
+	free_scratch_cube(p);
 
 	A = simplify(T);
 	foreach_set(A, last, p) {
 	    INLINEset_and(p, p, ceil);
 	}
 	*Tnew = A;
-	set_free(ceil);
+	free_scratch_cube(ceil);
 	return TRUE;
     }
-    set_free(ceil);
+    free_scratch_cube(ceil);
 
     /* Collect column counts, determine unate variables, etc. */
     massive_count(T);
@@ -0,0 +1,242 @@
+/*
+    Module: compl_cache.c -- a cache of the complements of cube lists
+
+    complement() splits on the most binate variable at each level, and
+    different paths through the recursion often reach the same cofactor
+    (split on x then y, or on y then x), and so do repeated calls such as
+    complement(cube2list(F, D)) on the same F and D.  With -cn, complement()
+    looks up each cube list which is not a special case before splitting
+    it, and saves the complement it computes.
+
+    complement() reads a cube p of a list only as p | T[0] (T[0] is the
+    cofactor), and reads T[0] by itself only for the parts of the
+    multiple-valued variable it splits (binate_split_select()): a binary
+    variable with a part in the cofactor is full in every cube of the
+    list, so it is never split again.  The key of a cube list is thus
+    the multiple-valued parts of T[0] followed by each p | T[0], in order,
+    and a saved complement is exactly the cover complement() would
+    compute again.  The two halves of a split have the same key when
+    the list does not depend on the splitting variable.
+
+    Each thread has a cache of its own, emptied whenever the cube
+    structure changes, and the least recently used entries are dropped
+    when the caches of all threads together would take more than
+    compl_cache_limit bytes.
+
+    With -s, compl_cache_print_stats() reports the lookups and hits.
+*/
+
+#include <atomic>
+#include <cstring>
+#include "espresso.h"
+
+#define CC_MIN_BUCKETS	1024
+
+struct cc_entry {
+    struct cc_entry *next;		/* in the bucket */
+    struct cc_entry *newer, *older;	/* in the order of use */
+    unsigned long hash;
+    long nwords;			/* words of the key */
+    set_word *key;
+    pcover Tbar;
+    long bytes;
+};
+
+struct cc_cache {
+    struct cc_entry **bucket;
+    long nbuckets, count;
+    struct cc_entry *newest, *oldest;
+    long bytes;				/* taken by this cache */
+    int size, num_vars, num_binary_vars;	/* the cube structure ... */
+    int *part_size;			/* ... of the entries */
+};
+
+static THREAD_LOCAL struct cc_cache cc_cache;
+
+THREAD_LOCAL long compl_cache_limit = 0;	/* -cn: n MB, 0 for no cache */
+static std::atomic<long> cc_bytes(0), cc_peak_bytes(0);
+static std::atomic<long> cc_lookups(0), cc_hits(0), cc_evicted(0);
+
+/* cc_unlink -- take 'e' out of the order of use */
+static void cc_unlink(struct cc_cache *c, struct cc_entry *e)
+{
+    if (e->newer != NULL) e->newer->older = e->older; else c->newest = e->older;
+    if (e->older != NULL) e->older->newer = e->newer; else c->oldest = e->newer;
+}
+
+/* cc_push -- make 'e' the most recently used entry */
+static void cc_push(struct cc_cache *c, struct cc_entry *e)
+{
+    e->newer = NULL;
+    e->older = c->newest;
+    if (c->newest != NULL) c->newest->newer = e; else c->oldest = e;
+    c->newest = e;
+}
+
+/* cc_drop -- remove the least recently used entry */
+static void cc_drop(struct cc_cache *c)
+{
+    struct cc_entry *e = c->oldest, **pe;
+
+    cc_unlink(c, e);
+    for(pe = &c->bucket[e->hash & (c->nbuckets - 1)]; *pe != e; pe = &(*pe)->next)
+	;
+    *pe = e->next;
+    c->count--;
+    c->bytes -= e->bytes;
+    cc_bytes.fetch_sub(e->bytes, std::memory_order_relaxed);
+    free_cover(e->Tbar);
+    delete [] e->key;
+    delete e;
+}
+
+/* compl_cache_clear -- empty the cache of this thread */
+void compl_cache_clear()
+{
+    struct cc_cache *c = &cc_cache;
+
+    while (c->oldest != NULL) {
+	cc_drop(c);
+    }
+    delete [] c->bucket;
+    delete [] c->part_size;
+    c->bucket = NULL;
+    c->part_size = NULL;
+    c->nbuckets = 0;
+}
+
+/* cc_setup -- get the cache of this thread ready for the cube structure */
+static struct cc_cache *cc_setup()
+{
+    struct cc_cache *c = &cc_cache;
+
+    if (c->bucket != NULL && c->size == cube.size && c->num_vars == cube.num_vars &&
+	    c->num_binary_vars == cube.num_binary_vars &&
+	    memcmp(c->part_size, cube.part_size, cube.num_vars * sizeof(int)) == 0) {
+	return c;
+    }
+    compl_cache_clear();
+    c->nbuckets = CC_MIN_BUCKETS;
+    c->bucket = new struct cc_entry *[c->nbuckets]();
+    c->size = cube.size;
+    c->num_vars = cube.num_vars;
+    c->num_binary_vars = cube.num_binary_vars;
+    c->part_size = new int[cube.num_vars + 1];
+    memcpy(c->part_size, cube.part_size, cube.num_vars * sizeof(int));
+    return c;
+}
+
+/* cc_grow -- double the number of buckets */
+static void cc_grow(struct cc_cache *c)
+{
+    struct cc_entry **old = c->bucket, *e, *enext;
+    long i, n = c->nbuckets;
+
+    c->nbuckets = 2 * n;
+    c->bucket = new struct cc_entry *[c->nbuckets]();
+    for(i = 0; i < n; i++) {
+	for(e = old[i]; e != NULL; e = enext) {
+	    enext = e->next;
+	    e->next = c->bucket[e->hash & (c->nbuckets - 1)];
+	    c->bucket[e->hash & (c->nbuckets - 1)] = e;
+	}
+    }
+    delete [] old;
+}
+
+/* compl_cache_key -- the key of the cube list T (for compl_cache_find()) */
+void compl_cache_key(pcube *T, compl_key_t *k)
+{
+    int i, w = LOOP(cube.fullset);
+    unsigned long h = 14695981039346656037UL;
+    pcube *T1, p, cof = T[0], mv = cube.mv_mask;
+    set_word *s;
+
+    k->nwords = (long) (CUBELISTSIZE(T) + 1) * w;
+    k->key = s = new set_word[k->nwords + 1];
+    for(i = 1; i <= w; i++) {
+	*s++ = cof[i] & mv[i];
+    }
+    for(T1 = T+2; (p = *T1++) != NULL; ) {
+	for(i = 1; i <= w; i++) {
+	    *s++ = p[i] | cof[i];
+	}
+    }
+    for(i = 0; i < k->nwords; i++) {
+	h = (h ^ k->key[i]) * 1099511628211UL;
+	h ^= h >> 29;
+    }
+    k->hash = h;
+}
+
+/* compl_cache_find -- a copy of the saved complement of 'k', or NULL */
+pcover compl_cache_find(compl_key_t *k)
+{
+    struct cc_cache *c = cc_setup();
+    struct cc_entry *e;
+
+    if (sf_keep_stats)
+	cc_lookups.fetch_add(1, std::memory_order_relaxed);
+    for(e = c->bucket[k->hash & (c->nbuckets - 1)]; e != NULL; e = e->next) {
+	if (e->hash == k->hash && e->nwords == k->nwords &&
+		memcmp(e->key, k->key, k->nwords * sizeof(set_word)) == 0) {
+	    cc_unlink(c, e);
+	    cc_push(c, e);
+	    if (sf_keep_stats)
+		cc_hits.fetch_add(1, std::memory_order_relaxed);
+	    delete [] k->key;
+	    return sf_save(e->Tbar);
+	}
+    }
+    return NULL;
+}
+
+/* compl_cache_save -- save a copy of 'Tbar' as the complement of 'k' */
+void compl_cache_save(compl_key_t *k, pcover Tbar)
+{
+    struct cc_cache *c = cc_setup();
+    struct cc_entry *e;
+    long bytes, peak;
+
+    bytes = sizeof(struct cc_entry) + sizeof(set_family_t) +
+	(k->nwords + (long) Tbar->count * Tbar->wsize) * sizeof(set_word);
+    while (c->oldest != NULL &&
+	    cc_bytes.load(std::memory_order_relaxed) + bytes > compl_cache_limit) {
+	cc_drop(c);
+	if (sf_keep_stats)
+	    cc_evicted.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (cc_bytes.load(std::memory_order_relaxed) + bytes > compl_cache_limit) {
+	delete [] k->key;		/* the other threads hold the room */
+	return;
+    }
+
+    e = new struct cc_entry;
+    e->hash = k->hash;
+    e->nwords = k->nwords;
+    e->key = k->key;
+    e->Tbar = sf_save(Tbar);
+    e->bytes = bytes;
+    e->next = c->bucket[e->hash & (c->nbuckets - 1)];
+    c->bucket[e->hash & (c->nbuckets - 1)] = e;
+    cc_push(c, e);
+    c->bytes += bytes;
+    if (++c->count > 2 * c->nbuckets) {
+	cc_grow(c);
+    }
+
+    bytes = cc_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    peak = cc_peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak && ! cc_peak_bytes.compare_exchange_weak(peak, bytes))
+	;
+}
+
+/* compl_cache_print_stats -- report on the complement cache (-s) */
+void compl_cache_print_stats()
+{
+    long lookups = cc_lookups.load(), hits = cc_hits.load();
+
+    printf("# COMPL CACHE   %ld lookups, %ld hits (%.1f%%), %ld evicted, peak %ld bytes\n",
+	lookups, hits, lookups > 0 ? 100.0 * hits / lookups : 0.0,
+	cc_evicted.load(), cc_peak_bytes.load());
+}
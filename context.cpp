@@ -0,0 +1,265 @@
+/*
+    Module: context.c -- minimizer contexts
+
+    The cube structure, cdata, the option flags and the few variables
+    which carry state from one call to the next are per-thread globals.
+    A context is a snapshot of all of them.  A thread which has read a
+    PLA turns its state into a context with context_new(); any thread may
+    then minimize with that context through the context_xxx() entry
+    points below, which install the context for the duration of the call
+    and restore the caller's own state afterwards.
+
+    A context must not be used by two threads at the same time (it owns
+    the scratch sets cube.temp and the cdata arrays).
+
+    What a context does not hold stays with the thread.  The memos which
+    remember answers from one call to the next -- the last irredundant
+    cover (irred.c), the kept reductions and expansions (reduce.c,
+    expand.c) and the complement cache (compl_cache.c) -- belong to the
+    minimization that filled them, so context_install() drops them
+    whenever the thread switches to another state; they are only
+    caches, and a minimization which is switched back in refills them.
+    The allocators (the cube list arena of arena.c and the set family
+    pools of set.c) hold no state of a minimization and are shared by
+    all the contexts which run on the thread.
+*/
+
+#include "espresso.h"
+
+/* context_save -- copy the state of this thread into "ctx" */
+void context_save(pcontext ctx)
+{
+    ctx->cube = cube;				/* structure copy ! */
+    ctx->cdata = cdata;				/*      ""          */
+    ctx->set_vector = set_vector;		/*      ""          */
+    ctx->pool_origin = pool_origin;
+    ctx->debug = debug;
+    ctx->verbose_debug = verbose_debug;
+    ctx->trace = trace;
+    ctx->summary = summary;
+    ctx->echo_comments = echo_comments;
+    ctx->echo_unknown_commands = echo_unknown_commands;
+    ctx->force_irredundant = force_irredundant;
+    ctx->skip_make_sparse = skip_make_sparse;
+    ctx->kiss = kiss;
+    ctx->pos = pos;
+    ctx->print_solution = print_solution;
+    ctx->recompute_onset = recompute_onset;
+    ctx->remove_essential = remove_essential;
+    ctx->single_expand = single_expand;
+    ctx->unwrap_onset = unwrap_onset;
+    ctx->use_random_order = use_random_order;
+    ctx->use_super_gasp = use_super_gasp;
+    ctx->reduce_toggle = reduce_toggle;
+    engine_options_save(&ctx->engine);
+}
+
+/* context_install -- make "ctx" the state of this thread */
+static void context_install(pcontext ctx)
+{
+    irred_forget();				/* the memos of the old state */
+    reduce_forget();
+    expand_forget();
+    compl_cache_clear();
+    cube = ctx->cube;				/* structure copy ! */
+    cdata = ctx->cdata;				/*      ""          */
+    set_vector = ctx->set_vector;		/*      ""          */
+    pool_origin = ctx->pool_origin;
+    debug = ctx->debug;
+    verbose_debug = ctx->verbose_debug;
+    trace = ctx->trace;
+    summary = ctx->summary;
+    echo_comments = ctx->echo_comments;
+    echo_unknown_commands = ctx->echo_unknown_commands;
+    force_irredundant = ctx->force_irredundant;
+    skip_make_sparse = ctx->skip_make_sparse;
+    kiss = ctx->kiss;
+    pos = ctx->pos;
+    print_solution = ctx->print_solution;
+    recompute_onset = ctx->recompute_onset;
+    remove_essential = ctx->remove_essential;
+    single_expand = ctx->single_expand;
+    unwrap_onset = ctx->unwrap_onset;
+    use_random_order = ctx->use_random_order;
+    use_super_gasp = ctx->use_super_gasp;
+    reduce_toggle = ctx->reduce_toggle;
+    engine_options_install(&ctx->engine);
+}
+
+/*
+    context_options -- install only the options of "ctx" on this thread
+
+    The thread keeps its own cube structure and scratch; this is how a
+    task run by the pool picks up the options of the thread which spawned
+    it (cube_share() only passes on the cube structure).
+*/
+void context_options(pcontext ctx)
+{
+    debug = ctx->debug;
+    verbose_debug = ctx->verbose_debug;
+    trace = ctx->trace;
+    summary = ctx->summary;
+    echo_comments = ctx->echo_comments;
+    echo_unknown_commands = ctx->echo_unknown_commands;
+    force_irredundant = ctx->force_irredundant;
+    skip_make_sparse = ctx->skip_make_sparse;
+    kiss = ctx->kiss;
+    pos = ctx->pos;
+    print_solution = ctx->print_solution;
+    recompute_onset = ctx->recompute_onset;
+    remove_essential = ctx->remove_essential;
+    single_expand = ctx->single_expand;
+    unwrap_onset = ctx->unwrap_onset;
+    use_random_order = ctx->use_random_order;
+    use_super_gasp = ctx->use_super_gasp;
+    reduce_toggle = ctx->reduce_toggle;
+    engine_options_install(&ctx->engine);
+}
+
+/* engine_options_save -- copy the engine options of this thread into "opt" */
+void engine_options_save(struct engine_options *opt)
+{
+    opt->use_huge_pages = use_huge_pages;
+    opt->mincov_engine = mincov_engine;
+    opt->mincov_lower_bound = mincov_lower_bound;
+    opt->mincov_time_budget = mincov_time_budget;
+    opt->mincov_node_budget = mincov_node_budget;
+    opt->compl_cache_limit = compl_cache_limit;
+    opt->reduce_mode = reduce_mode;
+    opt->irred_incremental_mode = irred_incremental_mode;
+    opt->pass_memo_mode = pass_memo_mode;
+}
+
+/* engine_options_install -- make "opt" the engine options of this thread */
+void engine_options_install(const struct engine_options *opt)
+{
+    use_huge_pages = opt->use_huge_pages;
+    mincov_engine = opt->mincov_engine;
+    mincov_lower_bound = opt->mincov_lower_bound;
+    mincov_time_budget = opt->mincov_time_budget;
+    mincov_node_budget = opt->mincov_node_budget;
+    compl_cache_limit = opt->compl_cache_limit;
+    reduce_mode = opt->reduce_mode;
+    irred_incremental_mode = opt->irred_incremental_mode;
+    pass_memo_mode = opt->pass_memo_mode;
+}
+
+/*
+    context_new -- take over the cube structure and options of this thread
+
+    The new context owns the cube structure; the thread is left without
+    one (as after save_cube_struct()), ready to read its next PLA.
+*/
+pcontext context_new()
+{
+    pcontext ctx = new espresso_context_t;
+
+    context_save(ctx);
+    ctx->pool_origin = NULL;
+
+    cube.first_part = cube.last_part = (int *) NULL;
+    cube.first_word = cube.last_word = (int *) NULL;
+    cube.part_size = (int *) NULL;
+    cube.sparse = (int *) NULL;
+    cube.binary_mask = cube.mv_mask = (pcube) NULL;
+    cube.fullset = cube.emptyset = (pcube) NULL;
+    cube.var_mask = cube.temp = (pcube *) NULL;
+
+    cdata.part_zeros = cdata.var_zeros = cdata.parts_active = (int *) NULL;
+    cdata.is_unate = (bool *) NULL;
+    return ctx;
+}
+
+/* context_free -- free a context and its cube structure */
+void context_free(pcontext ctx)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    setdown_cube();
+    delete cube.part_size;
+    cube.part_size = (int *) NULL;
+    context_leave(ctx, &save);
+    delete ctx;
+}
+
+/* context_enter -- install "ctx" on this thread, saving its state in "save" */
+void context_enter(pcontext ctx, pcontext save)
+{
+    context_save(save);
+    context_install(ctx);
+}
+
+/* context_leave -- write the state back into "ctx" and restore "save" */
+void context_leave(pcontext ctx, pcontext save)
+{
+    context_save(ctx);
+    context_install(save);
+}
+
+
+/*
+ *  The minimization steps, run with the state of a given context
+ */
+
+pcover context_espresso(pcontext ctx, pcover F, pcover D, pcover R)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    F = espresso(F, D, R);
+    context_leave(ctx, &save);
+    return F;
+}
+
+pcover context_expand(pcontext ctx, pcover F, pcover R, bool nonsparse)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    F = expand(F, R, nonsparse);
+    context_leave(ctx, &save);
+    return F;
+}
+
+pcover context_reduce(pcontext ctx, pcover F, pcover D)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    F = reduce(F, D);
+    context_leave(ctx, &save);
+    return F;
+}
+
+pcover context_irredundant(pcontext ctx, pcover F, pcover D)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    F = irredundant(F, D);
+    context_leave(ctx, &save);
+    return F;
+}
+
+pcover context_complement(pcontext ctx, pcube *T)
+{
+    espresso_context_t save;
+    pcover R;
+
+    context_enter(ctx, &save);
+    R = complement(T);
+    context_leave(ctx, &save);
+    return R;
+}
+
+pcover context_minimize_exact(pcontext ctx, pcover F, pcover D, pcover R,
+    int exact_cover)
+{
+    espresso_context_t save;
+
+    context_enter(ctx, &save);
+    F = minimize_exact(F, D, R, exact_cover);
+    context_leave(ctx, &save);
+    return F;
+}
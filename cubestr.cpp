@@ -71,6 +71,8 @@ void cube_setup()
     cdata.var_zeros = new int[cube.num_vars];
     cdata.parts_active = new int[cube.num_vars];
     cdata.is_unate = new int[cube.num_vars];
+
+    set_vector_setup();
 }
 
 /*
@@ -84,6 +86,9 @@ void setdown_cube()
 {
     int i, var;
 
+    irred_forget();
+    reduce_forget();
+    expand_forget();
     delete cube.first_part;
     delete cube.last_part;
     delete cube.first_word;
@@ -118,6 +123,50 @@ void setdown_cube()
     cdata.is_unate = (bool *) NULL;
 }
 
+/*
+    cube_share -- make the cube structure of this thread a copy of "from"
+
+    Used by the threads of the pool before they run a task for another
+    thread.  The read-only part of the cube structure is shared; the
+    scratch sets cube.temp and the cdata arrays belong to this thread and
+    are only reallocated when the shape of the cube changes.
+*/
+void cube_share(struct cube_struct *from)
+{
+    pset *temp = cube.temp;
+    int i, size = cube.size, num_vars = cube.num_vars;
+
+    if (from == &cube)
+	return;
+
+    cube = *from;				/* structure copy ! */
+    if (temp != NULL && size == cube.size && num_vars == cube.num_vars) {
+	cube.temp = temp;
+	return;
+    }
+
+    if (temp != NULL) {
+	for(i = 0; i < CUBE_TEMP; i++)
+	    free_cube(temp[i]);
+	delete temp;
+	delete cdata.part_zeros;
+	delete cdata.var_zeros;
+	delete cdata.parts_active;
+	delete cdata.is_unate;
+    }
+
+    cube.temp = new pset[CUBE_TEMP];
+    for(i = 0; i < CUBE_TEMP; i++)
+	cube.temp[i] = new_cube();
+
+    cdata.part_zeros = new int[cube.size];
+    cdata.var_zeros = new int[cube.num_vars];
+    cdata.parts_active = new int[cube.num_vars];
+    cdata.is_unate = new int[cube.num_vars];
+
+    set_vector_setup();
+}
+
 
 void save_cube_struct()
 {
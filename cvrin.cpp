@@ -4,11 +4,12 @@
 */
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include "espresso.h"
 
-static bool line_length_error;
-static int lineno;
+static THREAD_LOCAL bool line_length_error;
+static THREAD_LOCAL int lineno;
 
 void skip_line(std::istream& fpin, std::ostream& fpout, bool echo)
 {
@@ -33,14 +34,104 @@ char *get_word(std::istream& fp, char* word)
     return word;
 }
 
+/*
+ *  The values of a product term, shared by read_cube() and
+ *  read_cube_mapped(): each routine takes one character of the term,
+ *  sets the value it stands for, and returns TERM_SPACE for a separator
+ *  and TERM_BAD for anything else (the end of the line among them).
+ */
+
+/* read_binary_value -- binary variable var of cf from ch */
+int read_binary_value(int ch, pcube cf, int var)
+{
+    switch(ch) {
+	case ' ': case '|': case '\t':
+	    return TERM_SPACE;
+	case '2': case '-':
+	    set_insert(cf, var*2+1);
+	    /* FALLTHROUGH */
+	case '0':
+	    set_insert(cf, var*2);
+	    return 0;
+	case '1':
+	    set_insert(cf, var*2+1);
+	    return 0;
+	case '?':
+	    return 0;
+	default:
+	    return TERM_BAD;
+    }
+}
+
+/* read_mv_value -- part i of a multiple-valued variable of cf from ch */
+int read_mv_value(int ch, pcube cf, int i)
+{
+    switch(ch) {
+	case ' ': case '|': case '\t':
+	    return TERM_SPACE;
+	case '1':
+	    set_insert(cf, i);
+	    return 0;
+	case '0':
+	    return 0;
+	default:
+	    return TERM_BAD;
+    }
+}
+
+/*
+ *  read_output_value -- part i of the output variable from ch, into the
+ *  cover of 'type' it belongs to; returns that cover (F_type, D_type or
+ *  R_type), or 0 if it belongs to none being read
+ */
+int read_output_value(int ch, int i, pcube cf, pcube cd, pcube cr, int type)
+{
+    switch(ch) {
+	case ' ': case '|': case '\t':
+	    return TERM_SPACE;
+	case '4': case '1':
+	    if (type & F_type) {
+		set_insert(cf, i);
+		return F_type;
+	    }
+	    return 0;
+	case '3': case '0':
+	    if (type & R_type) {
+		set_insert(cr, i);
+		return R_type;
+	    }
+	    return 0;
+	case '2': case '-':
+	    if (type & D_type) {
+		set_insert(cd, i);
+		return D_type;
+	    }
+	    return 0;
+	case '~':
+	    return 0;
+	default:
+	    return TERM_BAD;
+    }
+}
+
+/* term_newline -- read_cube() found the end of the line inside a term */
+static void term_newline()
+{
+    if (! line_length_error)
+	fprintf(stderr, "product term(s) %s, line %d\n",
+	    "span more than one line (warning only)", lineno);
+    line_length_error = FALSE;
+    lineno++;
+}
+
 /*
  *  Yes, I know this routine is a mess
  */
 void read_cube(std::istream& fp, pPLA PLA)
 {
-    int var, i;
+    int var, i, ch, r;
     pcube cf = cube.temp[0], cr = cube.temp[1], cd = cube.temp[2];
-    bool savef = FALSE, saved = FALSE, saver = FALSE;
+    int save = 0;			/* the covers which take the term */
     char token[256]; 			/* for kiss read hack */
     int varx, first, last, offset;	/* for kiss read hack */
 
@@ -48,33 +139,13 @@ void read_cube(std::istream& fp, pPLA PLA)
 
     /* Loop and read binary variables */
     for(var = 0; var < cube.num_binary_vars; var++)
-	switch(fp.get()) {
-	    case EOF:
-		goto bad_char;
-	    case '\n':
-		if (! line_length_error)
-		    fprintf(stderr, "product term(s) %s, line %d\n",
-			"span more than one line (warning only)", lineno);
-		line_length_error = FALSE;
-		lineno++;
-		var--;
-		break;
-	    case ' ': case '|': case '\t':
-		var--;
-		break;
-	    case '2': case '-':
-		set_insert(cf, var*2+1);
-	    case '0':
-		set_insert(cf, var*2);
-		break;
-	    case '1':
-		set_insert(cf, var*2+1);
-		break;
-	    case '?':
-		break;
-	    default:
-		goto bad_char;
-	}
+	if ((ch = fp.get()) == '\n') {
+	    term_newline();
+	    var--;
+	} else if ((r = read_binary_value(ch, cf, var)) == TERM_BAD)
+	    goto bad_char;
+	else if (r == TERM_SPACE)
+	    var--;
 
 
     /* Loop for the all but one of the multiple-valued variables */	
@@ -118,81 +189,48 @@ void read_cube(std::istream& fp, pPLA PLA)
 	    }
 	
 	} else for(i = cube.first_part[var]; i <= cube.last_part[var]; i++)
-	    switch (fp.get()) {
-		case EOF:
-		    goto bad_char;
-		case '\n':
-		    if (! line_length_error)
-			fprintf(stderr, "product term(s) %s, line %d\n",
-			    "span more than one line (warning only)", lineno);
-		    line_length_error = FALSE;
-		    lineno++;
-		    i--;
-		    break;
-		case ' ': case '|': case '\t':
-		    i--;
-		    break;
-		case '1':
-		    set_insert(cf, i);
-		case '0':
-		    break;
-		default:
-		    goto bad_char;
-	    }
+	    if ((ch = fp.get()) == '\n') {
+		term_newline();
+		i--;
+	    } else if ((r = read_mv_value(ch, cf, i)) == TERM_BAD)
+		goto bad_char;
+	    else if (r == TERM_SPACE)
+		i--;
 
     /* Loop for last multiple-valued variable */
     if (kiss) {
-	saver = savef = TRUE;
+	save = F_type | R_type;
 	(void) set_xor(cr, cf, cube.var_mask[cube.num_vars - 2]);
     } else
 	set_copy(cr, cf);
     set_copy(cd, cf);
     for(i = cube.first_part[var]; i <= cube.last_part[var]; i++)
-	switch (fp.get()) {
-	    case EOF:
-		goto bad_char;
-	    case '\n':
-		if (! line_length_error)
-		    fprintf(stderr, "product term(s) %s, line %d\n",
-			"span more than one line (warning only)", lineno);
-		line_length_error = FALSE;
-		lineno++;
-		i--;
-		break;
-	    case ' ': case '|': case '\t':
-		i--;
-		break;
-	    case '4': case '1':
-		if (PLA->pla_type & F_type)
-		    set_insert(cf, i), savef = TRUE;
-		break;
-	    case '3': case '0':
-		if (PLA->pla_type & R_type)
-		    set_insert(cr, i), saver = TRUE;
-		break;
-	    case '2': case '-':
-		if (PLA->pla_type & D_type)
-		    set_insert(cd, i), saved = TRUE;
-	    case '~':
-		break;
-	    default:
-		goto bad_char;
-	}
-    if (savef) PLA->F = sf_addset(PLA->F, cf);
-    if (saved) PLA->D = sf_addset(PLA->D, cd);
-    if (saver) PLA->R = sf_addset(PLA->R, cr);
+	if ((ch = fp.get()) == '\n') {
+	    term_newline();
+	    i--;
+	} else if ((r = read_output_value(ch, i, cf, cd, cr, PLA->pla_type)) == TERM_BAD)
+	    goto bad_char;
+	else if (r == TERM_SPACE)
+	    i--;
+	else
+	    save |= r;
+    if (save & F_type) PLA->F = sf_addset(PLA->F, cf);
+    if (save & D_type) PLA->D = sf_addset(PLA->D, cd);
+    if (save & R_type) PLA->R = sf_addset(PLA->R, cr);
     return;
 
 bad_char:
     fprintf(stderr, "(warning): input line #%d ignored\n", lineno);
-    skip_line(fp, std::cout, true);
+    skip_line(fp, *espresso_out, true);
     return;
-}
+}
 void parse_pla(std::istream& fp, pPLA PLA)
 {
     int i, var, ch, np, last;
     char word[256];
+    std::streambuf *mapped = pla_mapped_buffer(fp);
 
+    np = 0;
     lineno = 1;
     line_length_error = FALSE;
 
@@ -209,7 +247,7 @@ loop:
 
 	case '#':
 	    (void) fp.unget();
-            skip_line(fp, std::cout, echo_comments);
+            skip_line(fp, *espresso_out, echo_comments);
 	    break;
 
 	case '.':
@@ -217,7 +255,7 @@ loop:
 	    if (equal(get_word(fp, word), "i")) {
 		if (cube.fullset != NULL) {
 		    fprintf(stderr, "extra .i ignored\n");
-            skip_line(fp, std::cout, /* echo */ false);
+            skip_line(fp, *espresso_out, /* echo */ false);
 		} else {
             fp >> cube.num_binary_vars;
             if (!fp.good()) {
@@ -231,7 +269,7 @@ loop:
 	    } else if (equal(word, "o")) {
 		if (cube.fullset != NULL) {
 		    fprintf(stderr, "extra .o ignored\n");
-            skip_line(fp, std::cout, /* echo */ false);
+            skip_line(fp, *espresso_out, /* echo */ false);
 		} else {
 		    if (cube.part_size == NULL) {
                 fatal(".o cannot appear before .i");
@@ -247,7 +285,7 @@ loop:
 	    } else if (equal(word, "mv")) {
 		if (cube.fullset != NULL) {
 		    fprintf(stderr, "extra .mv ignored\n");
-            skip_line(fp, std::cout, /* echo */ false);
+            skip_line(fp, *espresso_out, /* echo */ false);
 		} else {
 		    if (cube.part_size != nullptr)
                 fatal("cannot mix .i and .mv");
@@ -270,7 +308,7 @@ loop:
 		    PLA_labels(PLA);
 		}
 
-	    /* .p gives the number of product terms -- we ignore it */
+	    /* .p gives the number of product terms -- the first guess of the size of F (or R) */
         } else if (equal(word, "p")) {
             fp >> np;
         }
@@ -368,7 +406,7 @@ loop:
 		    fatal("PLA size must be declared before .phase");
 		if (PLA->phase != NULL) {
 		    fprintf(stderr, "extra .phase ignored\n");
-            skip_line(fp, std::cout, /* echo */ false);
+            skip_line(fp, *espresso_out, /* echo */ false);
 		} else {
 		    do ch = fp.get(); while (ch == ' ' || ch == '\t');
 		    (void) fp.unget();
@@ -418,9 +456,9 @@ loop:
 		
 	    } else {
             if (echo_unknown_commands) {
-                printf("%c%s ", ch, word);
+                *espresso_out << (char) ch << word << " ";
             }
-            skip_line(fp, std::cout, echo_unknown_commands);
+            skip_line(fp, *espresso_out, echo_unknown_commands);
 	    }
 	    break;
 	default:
@@ -428,17 +466,19 @@ loop:
 	    if (cube.fullset == NULL) {
 /*		fatal("unknown PLA size, need .i/.o or .mv");*/
             if (echo_comments) {
-                putchar('#');
+                *espresso_out << "#";
             }
-            skip_line(fp, std::cout, echo_comments);
+            skip_line(fp, *espresso_out, echo_comments);
             break;
 	    }
 	    if (PLA->F == NULL) {
-		PLA->F = new_cover(10);
+		np = std::max(np, 10);
+		PLA->F = new_cover((PLA->pla_type & F_type) ? np : 10);
 		PLA->D = new_cover(10);
-		PLA->R = new_cover(10);
+		PLA->R = new_cover((PLA->pla_type & (F_type|R_type)) == R_type ? np : 10);
 	    }
-	    read_cube(fp, PLA);
+	    if (mapped == NULL || ! read_cube_mapped(mapped, PLA))
+		read_cube(fp, PLA);
     }
     goto loop;
 }
@@ -573,7 +613,7 @@ int read_pla(std::istream& fp, bool needs_dcset, bool needs_offset, int pla_type
 EXECUTE(PLA->R=complement(cube2list(PLA->F,PLA->D)), COMPL_TIME, PLA->R, cost);
 	}
     }
-    std::cout << "After reading PLA\n";
+    *espresso_out << "After reading PLA\n";
     //fprint_pla(std::cout, PLA, F_type);
     
 
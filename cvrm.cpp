@@ -213,14 +213,16 @@ unsigned int comp_debug)
     pcube *T1, p, seed, cof;
     pcube *A1, *B1;
     bool change;
-    int count, numcube;
+    int count, numcube, i;
 
     numcube = static_cast<int>(CUBELISTSIZE(T));
 
-    /* Mark all cubes -- covered cubes belong to the partition */
-    for(T1 = T+2; (p = *T1++) != NULL; ) {
-	RESET(p, COVERED);
-    }
+    /*
+     *  Mark all cubes -- covered cubes belong to the partition.  The marks
+     *  are kept aside rather than in the COVERED flag: the cubes may be
+     *  shared with cubelists which other threads are working on.
+     */
+    std::vector<bool> covered(numcube, false);
 
     /*
      *  Extract a partition from the cubelist T; start with the first cube as a
@@ -229,15 +231,15 @@ unsigned int comp_debug)
      */
     seed = set_save(T[2]);
     cof = T[0];
-    SET(T[2], COVERED);
+    covered[0] = TRUE;
     count = 1;
 
     do {
 	change = FALSE;
-	for(T1 = T+2; (p = *T1++) != NULL; ) {
-	    if (! TESTP(p, COVERED) && ccommon(p, seed, cof)) {
+	for(T1 = T+2, i = 0; (p = *T1++) != NULL; i++) {
+	    if (! covered[i] && ccommon(p, seed, cof)) {
 		INLINEset_and(seed, seed, p);
-		SET(p, COVERED);
+		covered[i] = TRUE;
 		change = TRUE;
 		count++;
 	    }
@@ -254,16 +256,16 @@ unsigned int comp_debug)
 
     if (count != numcube) {
 	/* Allocate and setup the cubelist's for the two partitions */
-	*A = A1 = new pcube[numcube+3];
-	*B = B1 = new pcube[numcube+3];
-	(*A)[0] = set_save(T[0]);
-	(*B)[0] = set_save(T[0]);
+	*A = A1 = new_cubelist(numcube+3);
+	*B = B1 = new_cubelist(numcube+3);
+	(void) set_copy((*A)[0], T[0]);
+	(void) set_copy((*B)[0], T[0]);
 	A1 = *A + 2;
 	B1 = *B + 2;
 
 	/* Loop over the cubes in T and distribute to A and B */
-	for(T1 = T+2; (p = *T1++) != NULL; ) {
-	    if (TESTP(p, COVERED)) {
+	for(T1 = T+2, i = 0; (p = *T1++) != NULL; i++) {
+	    if (covered[i]) {
 		*A1++ = p;
 	    } else {
 		*B1++ = p;
@@ -329,14 +331,20 @@ pcover uncof_output(pcover T, int i)
  *  func1() is called after reforming the equivalent output function
  *
  *  Each function returns TRUE if process is to continue
+ *
+ *  Each output starts from the same reduce_toggle and unwrap_onset, as
+ *  in foreach_output_parallel(), and they are put back at the end.
  */
 void foreach_output_function(pPLA PLA, int (*func)(pPLA, int), int (*func1)(pPLA, int))
 {
     pPLA PLA1;
     int i;
+    bool toggle = reduce_toggle, unwrap = unwrap_onset;
 
     /* Loop for each output function */
     for(i = 0; i < cube.part_size[cube.output]; i++) {
+	reduce_toggle = toggle;
+	unwrap_onset = unwrap;
 
 	/* cofactor on the output part */
 	PLA1 = new_PLA();
@@ -347,7 +355,7 @@ void foreach_output_function(pPLA PLA, int (*func)(pPLA, int), int (*func1)(pPLA
 	/* Call a routine to do something with the cover */
 	if ((*func)(PLA1, i) == 0) {
 	    free_PLA(PLA1);
-	    return;
+	    break;
 	}
 
 	/* intersect with the particular output part again */
@@ -358,7 +366,7 @@ void foreach_output_function(pPLA PLA, int (*func)(pPLA, int), int (*func1)(pPLA
 	/* Call a routine to do something with the final result */
 	if ((*func1)(PLA1, i) == 0) {
 	    free_PLA(PLA1);
-	    return;
+	    break;
 	}
 
 	/* Cleanup for next go-around */
@@ -366,10 +374,95 @@ void foreach_output_function(pPLA PLA, int (*func)(pPLA, int), int (*func1)(pPLA
 	
 
     }
+    reduce_toggle = toggle;
+    unwrap_onset = unwrap;
 }
 
-static pcover Fmin;
-static pcube phase;
+
+/*
+ *  foreach_output_parallel -- foreach_output_function() on the thread pool
+ *
+ *  Each output is a candidate of a search (see search.c): func() runs as
+ *  a task of the pool, and func1() is called on this thread in output
+ *  order.  func() must not stop the loop.  so_done() frees the cofactor
+ *  and its result as soon as func1() has taken what it keeps, so only
+ *  the outputs in the window of the search are held at a time.
+ */
+struct so_search {
+    pPLA PLA;
+    int (*func)(pPLA, int);
+    int (*func1)(pPLA, int);
+};
+
+static pPLA so_cofactor(pPLA PLA, int i)
+{
+    pPLA PLA1 = new_PLA();
+
+    PLA1->F = cof_output(PLA->F, i + cube.first_part[cube.output]);
+    PLA1->R = cof_output(PLA->R, i + cube.first_part[cube.output]);
+    PLA1->D = cof_output(PLA->D, i + cube.first_part[cube.output]);
+    return PLA1;
+}
+
+static void *so_run(int i, void *arg)
+{
+    struct so_search *so = (struct so_search *) arg;
+    pPLA PLA1 = so_cofactor(so->PLA, i);
+
+    (void) (*so->func)(PLA1, i);
+    return (void *) PLA1;
+}
+
+static void so_done(int i, void *result, void *arg)
+{
+    struct so_search *so = (struct so_search *) arg;
+    pPLA PLA1 = (pPLA) result;
+
+    /* intersect with the particular output part again */
+    PLA1->F = uncof_output(PLA1->F, i + cube.first_part[cube.output]);
+    PLA1->R = uncof_output(PLA1->R, i + cube.first_part[cube.output]);
+    PLA1->D = uncof_output(PLA1->D, i + cube.first_part[cube.output]);
+
+    (void) (*so->func1)(PLA1, i);
+    free_PLA(PLA1);
+}
+
+static void foreach_output_parallel(pPLA PLA, int (*func)(pPLA, int),
+    int (*func1)(pPLA, int))
+{
+    struct so_search so;
+    search_t s;
+
+    so.PLA = PLA;
+    so.func = func;
+    so.func1 = func1;
+    search_init(&s, cube.part_size[cube.output]);
+    s.run = so_run;
+    s.done = so_done;
+    s.arg = (void *) &so;
+    search_run(&s);
+    if (s.n > 0) {
+	skip_make_sparse = 1;			/* as func() left it */
+    }
+}
+
+
+/*
+ *  so_foreach -- run the single-output minimizations, in parallel when
+ *  there is a pool and nothing is to be printed as they go
+ */
+static void so_foreach(pPLA PLA, int (*func)(pPLA, int),
+    int (*func1)(pPLA, int))
+{
+    if (pool_threads() > 1 && ! debug && ! trace && ! summary) {
+	foreach_output_parallel(PLA, func, func1);
+    } else {
+	foreach_output_function(PLA, func, func1);
+    }
+}
+
+static THREAD_LOCAL pcover Fmin;
+static THREAD_LOCAL pcube phase;
 
 /*
  *  minimize each output function individually
@@ -378,9 +471,9 @@ void so_espresso(pPLA PLA, int strategy)
 {
     Fmin = new_cover(PLA->F->count);
     if (strategy == 0) {
-	foreach_output_function(PLA, so_do_espresso, so_save);
+	so_foreach(PLA, so_do_espresso, so_save);
     } else {
-	foreach_output_function(PLA, so_do_exact, so_save);
+	so_foreach(PLA, so_do_exact, so_save);
     }
     sf_free(PLA->F);
     PLA->F = Fmin;
@@ -396,9 +489,9 @@ void so_both_espresso(pPLA PLA, int strategy)
     phase = set_save(cube.fullset);
     Fmin = new_cover(PLA->F->count);
     if (strategy == 0) {
-	foreach_output_function(PLA, so_both_do_espresso, so_both_save);
+	so_foreach(PLA, so_both_do_espresso, so_both_save);
     } else {
-	foreach_output_function(PLA, so_both_do_exact, so_both_save);
+	so_foreach(PLA, so_both_do_exact, so_both_save);
     }
     sf_free(PLA->F);
     PLA->F = Fmin;
@@ -0,0 +1,185 @@
+/*
+    Module: cvrmap.c -- memory-mapped PLA input
+
+    pla_open() maps a PLA file into memory and returns an istream whose
+    buffer is the mapping itself, so the characters are never copied;
+    pipes, stdin and files which cannot be mapped are read through an
+    ifstream as before.  parse_pla() keeps reading the keywords from the
+    stream, and hands each product term of a mapped file to
+    read_cube_mapped(), which scans it in place and builds the cubes
+    straight into the last set of F, D and R (sf_addroom()).
+
+    read_cube_mapped() accepts exactly what read_cube() accepts: a term
+    it cannot take in one go (a symbolic variable, .kiss, a term which
+    spans lines, a bad character or the end of the file) is left
+    untouched, and read_cube() reads it instead, with its warnings.  The
+    binary variables are classified 16 characters at a time with SSE2:
+    a run of 16 of '0', '1', '-', '2' and '?' gives 32 bits of the cube
+    at once, and anything else (the separators ' ', '|' and tab among
+    them) is handled one character at a time.  Both readers take the
+    values of a term through read_binary_value(), read_mv_value() and
+    read_output_value() in cvrin.c, so they cannot drift apart.
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include "espresso.h"
+
+#if defined(__SSE2__) && BPI != 16
+#include <emmintrin.h>
+#define CVRMAP_SSE2
+#endif
+
+/* A streambuf over the mapping: underflow() is only reached at the end */
+class pla_mapped_buf : public std::streambuf {
+  public:
+    pla_mapped_buf(char *base, size_t size) : base(base), size(size)
+	{ setg(base, base, base + size); }
+    ~pla_mapped_buf()
+	{ (void) munmap(base, size); }
+    const char *next() { return gptr(); }
+    const char *end() { return egptr(); }
+    void advance(int n) { gbump(n); }
+  private:
+    char *base;
+    size_t size;
+};
+
+class pla_mapped_stream : public std::istream {
+  public:
+    pla_mapped_stream(char *base, size_t size) : std::istream(NULL), buf(base, size)
+	{ rdbuf(&buf); }
+  private:
+    pla_mapped_buf buf;
+};
+
+/* pla_open -- an istream on the PLA file 'fname', mapped when possible */
+std::istream *pla_open(const char *fname)
+{
+    struct stat st;
+    void *base;
+    int fd;
+
+    if ((fd = open(fname, O_RDONLY)) >= 0) {
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+	    base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (base != MAP_FAILED) {
+		(void) madvise(base, (size_t) st.st_size, MADV_SEQUENTIAL);
+		(void) close(fd);
+		return new pla_mapped_stream((char *) base, (size_t) st.st_size);
+	    }
+	}
+	(void) close(fd);
+    }
+    return new std::ifstream(fname);
+}
+
+/* pla_mapped_buffer -- the buffer of 'fp' if it reads a mapped file, else NULL */
+std::streambuf *pla_mapped_buffer(std::istream& fp)
+{
+    return dynamic_cast<pla_mapped_buf *>(fp.rdbuf());
+}
+
+#ifdef CVRMAP_SSE2
+/* spread16 -- bit i of x moves to bit 2i */
+static inline unsigned int spread16(unsigned int x)
+{
+    x = (x | x << 8) & 0x00ff00ff;
+    x = (x | x << 4) & 0x0f0f0f0f;
+    x = (x | x << 2) & 0x33333333;
+    x = (x | x << 1) & 0x55555555;
+    return x;
+}
+
+/* map_binary16 -- vars var..var+n-1 from 16 characters at s, FALSE if not all valid */
+static inline bool map_binary16(const char *s, int n, int var, pcube cf)
+{
+    __m128i x = _mm_loadu_si128((const __m128i *) s);
+    unsigned int zero, one, dash, mark, need;
+
+    zero = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('0')));
+    one = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('1')));
+    dash = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('-')),
+					  _mm_cmpeq_epi8(x, _mm_set1_epi8('2'))));
+    mark = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('?')));
+    need = (1u << n) - 1;
+    if (((zero | one | dash | mark) & need) != need)
+	return FALSE;
+    cf[WHICH_WORD(2*var)] |= (set_word) (spread16((zero | dash) & need) |
+	spread16((one | dash) & need) << 1) << WHICH_BIT(2*var);
+    return TRUE;
+}
+#endif
+
+/*
+ *  read_cube_mapped -- read_cube() from the mapping, FALSE (with nothing
+ *  read) if read_cube() has to read this term
+ */
+bool read_cube_mapped(std::streambuf *buf, pPLA PLA)
+{
+    pla_mapped_buf *mb = static_cast<pla_mapped_buf *>(buf);
+    const char *s = mb->next(), *end = mb->end();
+    int var, i, n, r, type = PLA->pla_type;
+    pcube cf, cr, cd;
+    int save = 0;
+
+    if (kiss) {
+	return FALSE;
+    }
+    for(var = cube.num_binary_vars; var < cube.num_vars - 1; var++)
+	if (cube.part_size[var] < 0)
+	    return FALSE;
+
+    cf = (type & F_type) ? sf_addroom(PLA->F) : cube.temp[0];
+    set_clear(cf, cube.size);
+
+    /* Loop and read binary variables */
+    for(var = 0; var < cube.num_binary_vars; ) {
+#ifdef CVRMAP_SSE2
+	n = std::min(16, cube.num_binary_vars - var);
+	if (var % 16 == 0 && end - s >= 16 && map_binary16(s, n, var, cf)) {
+	    s += n;
+	    var += n;
+	    continue;
+	}
+#endif
+	if (s == end || (r = read_binary_value(*s++, cf, var)) == TERM_BAD)
+	    return FALSE;
+	if (r != TERM_SPACE)
+	    var++;
+    }
+
+    /* Loop for the all but one of the multiple-valued variables */
+    for(var = cube.num_binary_vars; var < cube.num_vars-1; var++)
+	for(i = cube.first_part[var]; i <= cube.last_part[var]; i++) {
+	    if (s == end || (r = read_mv_value(*s++, cf, i)) == TERM_BAD)
+		return FALSE;
+	    if (r == TERM_SPACE)
+		i--;
+	}
+
+    /* Loop for last multiple-valued variable */
+    cr = cd = NULL;
+    if (type & R_type)
+	cr = set_copy(sf_addroom(PLA->R), cf);
+    if (type & D_type)
+	cd = set_copy(sf_addroom(PLA->D), cf);
+    for(i = cube.first_part[var]; i <= cube.last_part[var]; i++) {
+	if (s == end || (r = read_output_value(*s++, i, cf, cd, cr, type)) == TERM_BAD)
+	    return FALSE;
+	if (r == TERM_SPACE)
+	    i--;
+	else
+	    save |= r;
+    }
+
+    if (save & F_type) PLA->F->count++;
+    if (save & D_type) PLA->D->count++;
+    if (save & R_type) PLA->R->count++;
+    mb->advance((int) (s - mb->next()));
+    return TRUE;
+}
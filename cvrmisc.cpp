@@ -44,7 +44,7 @@ void cover_cost(pcover F, pcost cost)
 /* fmt_cost -- return a string which reports the "cost" of a cover */
 char *fmt_cost(pcost cost)
 {
-    static char s[200];
+    static THREAD_LOCAL char s[200];
 
     if (cube.num_binary_vars == cube.num_vars - 1)
 	(void) sprintf(s, "c=%d(%d) in=%d out=%d tot=%d",
@@ -89,9 +89,8 @@ void size_stamp(pcover T, const char * name)
 /* print_trace -- print a line reporting size and time after a function */
 void print_trace(pcover T, const char* name, const std::chrono::duration<double>& time)
 {
-    printf("# %s\tTime was %s, cost is %s\n",
-	name, print_time(time).c_str(), print_cost(T));
-    (void) fflush(stdout);
+    *espresso_out << "# " << name << "\tTime was " << print_time(time) <<
+	", cost is " << print_cost(T) << std::endl;
 }
 
 
@@ -99,7 +98,7 @@ void print_trace(pcover T, const char* name, const std::chrono::duration<double>
 void totals(const std::chrono::time_point<std::chrono::high_resolution_clock>& time, int i, pcover T, pcost cost)
 {
     const auto duration = ptime() - time;
-    total_time[i] += duration;
+    total_time[i] += std::chrono::duration<double>(duration).count();
     total_calls[i]++;
     cover_cost(T, cost);
     if (trace) {
@@ -114,5 +113,5 @@ void totals(const std::chrono::time_point<std::chrono::high_resolution_clock>& t
 void fatal(const char * s)
 {
     fprintf(stderr, "espresso: %s\n", s);
-    exit(1);
+    pool_exit(1);
 }
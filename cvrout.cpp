@@ -338,9 +338,9 @@ void print_expanded_cube(std::ostream& fp, pcube c, pcube phase)
 
 
 char *pc1(pcube c)
-{static char s1[256];return fmt_cube(c, "01", s1);}
+{static THREAD_LOCAL char s1[256];return fmt_cube(c, "01", s1);}
 char *pc2(pcube c)
-{static char s2[256];return fmt_cube(c, "01", s2);}
+{static THREAD_LOCAL char s2[256];return fmt_cube(c, "01", s2);}
 
 
 void debug_print(pcube * T, const char * name, int level)
@@ -1,18 +1,197 @@
+#include <algorithm>
 #include "mincov_int.h"
 
+/*
+ *  Containment tests for the dominance checks
+ *
+ *  A row (column) is deleted when some other row (column) dominates it,
+ *  and dominance is transitive, so the rows and columns deleted do not
+ *  depend on the order in which the pairs are tried: the dominator with
+ *  the largest key is never deleted itself.  The rows are visited by
+ *  increasing length; a row still there when its turn comes stays, and
+ *  a deleted row is never compared again.
+ *
+ *  Before two element lists are compared, their signatures (element n
+ *  sets bit n % 64) and ranges are checked.  If those allow containment,
+ *  the packed copies of the lists are compared a word at a time; a list
+ *  which spans more words than it has elements is not packed, and then
+ *  the lists themselves are compared (sm_row_contains(), sm_col_contains()),
+ *  as they are when the packed copies would take more than DOM_MAX_WORDS.
+ */
 
-int 
+typedef unsigned long long dom_word;
+#define DOM_BITS	64
+#define DOM_MAX_WORDS	(1 << 22)
+
+typedef struct dom_set_struct dom_set;
+struct dom_set_struct {
+    dom_word sig;		/* bit n % 64 for each element n */
+    int first, last;		/* words of the first and last element */
+    dom_word *bits;		/* words first..last, or nullptr */
+};
+
+typedef struct dom_table_struct dom_table;
+struct dom_table_struct {
+    dom_set *set;		/* by row (column) number */
+    char *done;			/* set[n] has been filled in */
+    dom_word *pool, *next;	/* words for the packed copies */
+};
+
+/* dom_alloc -- an empty table for numbers below 'size' */
+static void
+dom_alloc(dom_table * t, int size, long words)
+{
+    t->set = new dom_set[size];
+    t->done = new char[size]();
+    t->pool = t->next = words <= DOM_MAX_WORDS ? new dom_word[words] : nullptr;
+}
+
+static void
+dom_free(dom_table * t)
+{
+    delete [] t->set;
+    delete [] t->done;
+    delete [] t->pool;
+}
+
+/* dom_packed -- is a list of 'length' elements from 'first' to 'last' packed ? */
+#define dom_packed(length, first, last) \
+    ((last) / DOM_BITS - (first) / DOM_BITS < (length))
+
+/* dom_start -- fill in the signature and range of an element list */
+static dom_set *
+dom_start(dom_table * t, int n, int length, int first, int last)
+{
+    dom_set *s = &t->set[n];
+
+    t->done[n] = 1;
+    s->sig = 0;
+    s->first = first / DOM_BITS;
+    s->last = last / DOM_BITS;
+    s->bits = nullptr;
+    if (t->next != nullptr && dom_packed(length, first, last)) {
+	s->bits = t->next;
+	t->next += s->last - s->first + 1;
+	for(n = 0; n <= s->last - s->first; n++) {
+	    s->bits[n] = 0;
+	}
+    }
+    return s;
+}
+
+/* dom_add -- add element 'n' to 's' */
+#define dom_add(s, n) {\
+    (s)->sig |= (dom_word) 1 << ((n) % DOM_BITS);\
+    if ((s)->bits != nullptr)\
+	(s)->bits[(n) / DOM_BITS - (s)->first] |= (dom_word) 1 << ((n) % DOM_BITS);\
+}
+
+/* dom_row -- the dom_set of a row, made when first needed */
+static dom_set *
+dom_row(dom_table * t, sm_row * prow)
+{
+    dom_set *s;
+    sm_element *p;
+
+    if (t->done[prow->row_num]) {
+	return &t->set[prow->row_num];
+    }
+    s = dom_start(t, prow->row_num, prow->length,
+		  prow->first_col->col_num, prow->last_col->col_num);
+    sm_foreach_row_element(prow, p) {
+	dom_add(s, p->col_num);
+    }
+    return s;
+}
+
+/* dom_col -- the dom_set of a column, made when first needed */
+static dom_set *
+dom_col(dom_table * t, sm_col * pcol)
+{
+    dom_set *s;
+    sm_element *p;
+
+    if (t->done[pcol->col_num]) {
+	return &t->set[pcol->col_num];
+    }
+    s = dom_start(t, pcol->col_num, pcol->length,
+		  pcol->first_row->row_num, pcol->last_row->row_num);
+    sm_foreach_col_element(pcol, p) {
+	dom_add(s, p->row_num);
+    }
+    return s;
+}
+
+/* dom_contains -- 0 if 'a' cannot be contained in 'b', 1 if it is, -1 if unknown */
+static int
+dom_contains(dom_set * a, dom_set * b)
+{
+    dom_word *pa, *pb;
+    int k, n;
+
+    if ((a->sig & ~b->sig) != 0 || a->first < b->first || a->last > b->last) {
+	return 0;
+    }
+    if (a->bits == nullptr || b->bits == nullptr) {
+	return -1;
+    }
+    pa = a->bits;
+    pb = b->bits + (a->first - b->first);
+    n = a->last - a->first;
+    for(k = 0; k <= n; k++) {
+	if ((pa[k] & ~pb[k]) != 0) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+
+int
 sm_row_dominance(sm_matrix * A)
 {
     sm_row *prow, *prow1;
     sm_col *pcol, *least_col;
     sm_element *p, *pnext;
-    int rowcnt;
+    dom_table t;
+    int *order, *start;
+    int i, n, len, contains, rowcnt;
+    long words;
 
     rowcnt = A->nrows;
+    if (rowcnt < 2) {
+	return 0;
+    }
 
-    /* Check each row against all other rows */
-    for(prow = A->first_row; prow != 0; prow = prow->next_row) {
+    /* Sort the rows by length, in order of number within a length */
+    len = 0;
+    words = 0;
+    sm_foreach_row(A, prow) {
+	len = std::max(len, prow->length);
+	if (dom_packed(prow->length, prow->first_col->col_num, prow->last_col->col_num)) {
+	    words += prow->last_col->col_num / DOM_BITS -
+		     prow->first_col->col_num / DOM_BITS + 1;
+	}
+    }
+    start = new int[len + 2]();
+    sm_foreach_row(A, prow) {
+	start[prow->length + 1]++;
+    }
+    for(i = 1; i <= len; i++) {
+	start[i + 1] += start[i];
+    }
+    order = new int[rowcnt];
+    sm_foreach_row(A, prow) {
+	order[start[prow->length]++] = prow->row_num;
+    }
+    dom_alloc(&t, A->rows_size, words);
+
+    /* Check each row against the longer rows */
+    for(n = 0; n < rowcnt; n++) {
+	prow = sm_get_row(A, order[n]);
+	if (prow == nullptr) {
+	    continue;		/* deleted by a shorter row */
+	}
 
 	/* Among all columns with a 1 in this row, choose smallest */
 	least_col = sm_get_col(A, prow->first_col->col_num);
@@ -29,19 +208,26 @@ sm_row_dominance(sm_matrix * A)
 
 	    prow1 = sm_get_row(A, p->row_num);
 	    if ((prow1->length > prow->length) ||
-	              (prow1->length == prow->length && 
+	              (prow1->length == prow->length &&
 			      prow1->row_num > prow->row_num)) {
-		if (sm_row_contains(prow, prow1)) {
+		contains = dom_contains(dom_row(&t, prow), dom_row(&t, prow1));
+		if (contains < 0) {
+		    contains = sm_row_contains(prow, prow1);
+		}
+		if (contains) {
 		    sm_delrow(A, prow1->row_num);
 		}
 	    }
 	}
     }
 
+    dom_free(&t);
+    delete [] order;
+    delete [] start;
     return rowcnt - A->nrows;
 }
-
-int 
+
+int
 sm_col_dominance(sm_matrix * A, int * weight)
 {
     sm_row *prow;
@@ -49,9 +235,22 @@ sm_col_dominance(sm_matrix * A, int * weight)
     sm_element *p;
     sm_row *least_row;
     sm_col *next_col;
-    int colcnt;
+    dom_table t;
+    int contains, colcnt;
+    long words;
 
     colcnt = A->ncols;
+    if (colcnt < 2) {
+	return 0;
+    }
+    words = 0;
+    sm_foreach_col(A, pcol) {
+	if (dom_packed(pcol->length, pcol->first_row->row_num, pcol->last_row->row_num)) {
+	    words += pcol->last_row->row_num / DOM_BITS -
+		     pcol->first_row->row_num / DOM_BITS + 1;
+	}
+    }
+    dom_alloc(&t, A->cols_size, words);
 
     /* Check each column against all other columns */
     for(pcol = A->first_col; pcol != 0; pcol = next_col) {
@@ -72,9 +271,13 @@ sm_col_dominance(sm_matrix * A, int * weight)
 	    if (weight != 0 && weight[pcol1->col_num] > weight[pcol->col_num])
 		continue;
 	    if ((pcol1->length > pcol->length) ||
-	       (pcol1->length == pcol->length && 
+	       (pcol1->length == pcol->length &&
 			       pcol1->col_num > pcol->col_num)) {
-		if (sm_col_contains(pcol, pcol1)) {
+		contains = dom_contains(dom_col(&t, pcol), dom_col(&t, pcol1));
+		if (contains < 0) {
+		    contains = sm_col_contains(pcol, pcol1);
+		}
+		if (contains) {
 		    sm_delcol(A, pcol->col_num);
 		    break;
 		}
@@ -82,5 +285,6 @@ sm_col_dominance(sm_matrix * A, int * weight)
 	}
     }
 
+    dom_free(&t);
     return colcnt - A->ncols;
 }
@@ -38,7 +38,22 @@
 
 #include "espresso.h"
 
+THREAD_LOCAL std::ostream *espresso_out = &std::cout;	/* progress messages */
+
 pcover espresso(pcover F, pcover D1, pcover R)
+{
+    return espresso_search(F, D1, R, (psearch) NULL, 0);
+}
+
+/*
+ *  espresso_search -- espresso() for candidate "candidate" of the search
+ *  "s"; returns NULL (and gives up after the essential primes) if the
+ *  candidate cannot beat the best one found so far
+ *
+ *  Every cover needs a cube of its own for each essential prime, and one
+ *  more if anything is left once they are taken out.
+ */
+pcover espresso_search(pcover F, pcover D1, pcover R, psearch s, int candidate)
 {
     pcover E, D, Fsave;
     pset last, p;
@@ -64,9 +79,9 @@ begin:
     foreach_set(F, last, p) {
 	RESET(p, PRIME);
     }
-    std::cout << "Before expanding" << std::endl;
+    *espresso_out << "Before expanding" << std::endl;
     EXECUTE(F = expand(F, R, FALSE), EXPAND_TIME, F, cost);
-    std::cout << "Before irredundant" << std::endl;
+    *espresso_out << "Before irredundant" << std::endl;
     EXECUTE(F = irredundant(F, D), IRRED_TIME, F, cost);
 
     if (! single_expand) {
@@ -76,8 +91,18 @@ begin:
 	    E = new_cover(0);
 	}
 
+	/* Give up if this cannot beat the best candidate of the search */
+	if (s != NULL && ! search_can_win(s, candidate,
+		E->count + (F->count > 0 ? 1 : 0))) {
+	    free_cover(E);
+	    free_cover(F);
+	    free_cover(D);
+	    free_cover(Fsave);
+	    return NULL;
+	}
+
 	cover_cost(F, &cost);
-    std::cout << "Entering main loop, Number of cubes " << cost.cubes << std::endl;
+    *espresso_out << "Entering main loop, Number of cubes " << cost.cubes << std::endl;
 	do {
 
 	    /* Repeat inner loop until solution becomes "stable" */
@@ -86,7 +111,7 @@ begin:
 		EXECUTE(F = reduce(F, D), REDUCE_TIME, F, cost);
 		EXECUTE(F = expand(F, R, FALSE), EXPAND_TIME, F, cost);
 		EXECUTE(F = irredundant(F, D), IRRED_TIME, F, cost);
-            std::cout << "Number of cubes " << cost.cubes << std::endl;
+            *espresso_out << "Number of cubes " << cost.cubes << std::endl;
 	    } while (cost.cubes < best_cost.cubes);
 
 	    /* Perturb solution to see if we can continue to iterate */
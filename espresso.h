@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <chrono>
+#include "threadlocal.h"
 #include "sparse.h"
 #include "mincov.h"
 
@@ -25,6 +26,7 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <atomic>
 
 /*-----THIS USED TO BE set.h----- */
 
@@ -45,23 +47,33 @@
  *   A family of sets is a two-dimensional matrix of bits and is
  *   implemented with the data type "set_family".
  *
- *   BPI == 32 and BPI == 16 have been tested and work.
+ *   BPI == 32 and BPI == 16 have been tested and work.  BPI == 64 packs
+ *   the set data into "unsigned long long" words; it is selected at build
+ *   time with -DBPI=64 and halves the number of iterations of every word
+ *   loop over a cube.
  */
 
 
-/* Define host machine characteristics of "unsigned int" */
+/* Define host machine characteristics of a set word */
 #ifndef BPI
 #define BPI             32              /* # bits per integer */
 #endif
 
-#if BPI == 32
+#if BPI == 64
+#define LOGBPI          6               /* log(BPI)/log(2) */
+#elif BPI == 32
 #define LOGBPI          5               /* log(BPI)/log(2) */
 #else
 #define LOGBPI          4               /* log(BPI)/log(2) */
 #endif
 
-/* Define the set type */
-typedef unsigned int *pset;
+/* Define the set word and the set type */
+#if BPI == 64
+typedef unsigned long long set_word;
+#else
+typedef unsigned int set_word;
+#endif
+typedef set_word *pset;
 
 /* Define the set family type -- an array of sets */
 typedef struct set_family {
@@ -78,29 +90,37 @@ typedef struct set_family {
 #define WHICH_WORD(element)     (((element) >> LOGBPI) + 1)
 #define WHICH_BIT(element)      ((element) & (BPI-1))
 
-/* # of ints needed to allocate a set with "size" elements */
-#if BPI == 32
+/* # of words needed to allocate a set with "size" elements */
+#if BPI == 64
 #define SET_SIZE(size)          ((size) <= BPI ? 2 : (WHICH_WORD((size)-1) + 1))
 #else
 #define SET_SIZE(size)          ((size) <= BPI ? 3 : (WHICH_WORD((size)-1) + 2))
 #endif
 
 /*
- *  Three fields are maintained in the first word of the set
+ *  Three fields are maintained in the header of the set
  *      LOOP is the index of the last word used for set data
  *      LOOPCOPY is the index of the last word in the set
  *      SIZE is available for general use (e.g., recording # elements in set)
  *      NELEM retrieves the number of elements in the set
+ *
+ *  LOOP takes the low 26 bits of set[0] and the flags the next 6 bits.
+ *  With 64-bit words SIZE is the upper half of set[0]; otherwise it has
+ *  a word of its own after the set data.  Either way a set may have up
+ *  to 2^26 - 1 words and SIZE holds any int (e.g., the index of a cube
+ *  in a cover of millions of cubes).  Both read back as an int.
  */
-#define LOOP(set)               (set[0] & 0x03ff)
-#define PUTLOOP(set, i)         (set[0] &= ~0x03ff, set[0] |= (i))
-#if BPI == 32
+#define LOOPMASK                0x03ffffff
+#define LOOP(set)               ((int) (set[0] & LOOPMASK))
+#define PUTLOOP(set, i)         (set[0] &= ~ (set_word) LOOPMASK, set[0] |= (i))
+#if BPI == 64
 #define LOOPCOPY(set)           LOOP(set)
-#define SIZE(set)               (set[0] >> 16)
-#define PUTSIZE(set, size)      (set[0] &= 0xffff, set[0] |= ((size) << 16))
+#define SIZE(set)               ((int) (set[0] >> 32))
+#define PUTSIZE(set, size)\
+    (set[0] &= 0xffffffff, set[0] |= (set_word) (unsigned int) (size) << 32)
 #else
 #define LOOPCOPY(set)           (LOOP(set) + 1)
-#define SIZE(set)               (set[LOOP(set)+1])
+#define SIZE(set)               ((int) set[LOOP(set)+1])
 #define PUTSIZE(set, size)      ((set[LOOP(set)+1]) = (size))
 #endif
 
@@ -111,16 +131,16 @@ typedef struct set_family {
  *      FLAGS store general information about the set
  */
 #define SET(set, flag)          (set[0] |= (flag))
-#define RESET(set, flag)        (set[0] &= ~ (flag))
+#define RESET(set, flag)        (set[0] &= ~ (set_word) (flag))
 #define TESTP(set, flag)        (set[0] & (flag))
 
 /* Flag definitions are ... */
-#define PRIME           0x8000          /* cube is prime */
-#define NONESSEN        0x4000          /* cube cannot be essential prime */
-#define ACTIVE          0x2000          /* cube is still active */
-#define REDUND          0x1000          /* cube is redundant(at this point) */
-#define COVERED         0x0800          /* cube has been covered */
-#define RELESSEN        0x0400          /* cube is relatively essential */
+#define PRIME           0x80000000      /* cube is prime */
+#define NONESSEN        0x40000000      /* cube cannot be essential prime */
+#define ACTIVE          0x20000000      /* cube is still active */
+#define REDUND          0x10000000      /* cube is redundant(at this point) */
+#define COVERED         0x08000000      /* cube has been covered */
+#define RELESSEN        0x04000000      /* cube is relatively essential */
 
 /* Most efficient way to look at all members of a set family */
 #define foreach_set(R, last, p)\
@@ -152,15 +172,37 @@ typedef struct set_family {
 #define GETSET(family, index)   ((family)->data + (family)->wsize * (index))
 
 /* Allocate and deallocate sets */
-#define set_new(size)   set_clear(new unsigned int[SET_SIZE(size)], size)
-#define set_full(size)  set_fill(new unsigned int[SET_SIZE(size)], size)
-#define set_save(r)     set_copy(new unsigned int[SET_SIZE(NELEM(r))], r)
+#define set_new(size)   set_clear(new set_word[SET_SIZE(size)], size)
+#define set_full(size)  set_fill(new set_word[SET_SIZE(size)], size)
+#define set_save(r)     set_copy(new set_word[SET_SIZE(NELEM(r))], r)
 #define set_free(r)     delete(r)
 
 /* Check for set membership, remove set element and insert set element */
-#define is_in_set(set, e)       (set[WHICH_WORD(e)] & (1 << WHICH_BIT(e)))
-#define set_remove(set, e)      (set[WHICH_WORD(e)] &= ~ (1 << WHICH_BIT(e)))
-#define set_insert(set, e)      (set[WHICH_WORD(e)] |= 1 << WHICH_BIT(e))
+#define is_in_set(set, e)       (set[WHICH_WORD(e)] & ((set_word) 1 << WHICH_BIT(e)))
+#define set_remove(set, e)      (set[WHICH_WORD(e)] &= ~ ((set_word) 1 << WHICH_BIT(e)))
+#define set_insert(set, e)      (set[WHICH_WORD(e)] |= (set_word) 1 << WHICH_BIT(e))
+
+/*
+ *  Vector kernels for long sets (setv.c).  set_vector_setup() fills in
+ *  the kernels the CPU supports; a NULL entry means "use the scalar loop".
+ *  The set kernels operate on words 1..n of their arguments.
+ */
+struct set_vector_struct {
+    int words;			/* use the set kernels from this LOOP() on */
+    int bits;			/* vector width in use (0 if none) */
+    void (*set_and)(pset r, pset a, pset b, int n);
+    void (*set_or)(pset r, pset a, pset b, int n);
+    void (*set_diff)(pset r, pset a, pset b, int n);
+    int (*setp_implies)(pset a, pset b, int n);
+    int (*setp_disjoint)(pset a, pset b, int n);
+    int (*setp_equal)(pset a, pset b, int n);
+    int (*cdist0)(pset a, pset b);	/* the cube kernels of setc.c */
+    int (*cdist01)(pset a, pset b);
+    int (*cdist)(pset a, pset b);
+    pset (*force_lower)(pset xlower, pset a, pset b);
+    void (*consensus)(pset r, pset a, pset b);
+};
+extern THREAD_LOCAL struct set_vector_struct set_vector;
 
 /* Inline code substitution for those places that REALLY need it on a VAX */
 #ifdef NO_INLINE
@@ -186,18 +228,21 @@ typedef struct set_family {
 #define INLINEset_copy(r, a)\
     {int i_=LOOPCOPY(a); do r[i_]=a[i_]; while (--i_>=0);}
 #define INLINEset_clear(r, size)\
-    {int i_=LOOPINIT(size); *r=i_; do r[i_] = 0; while (--i_ > 0);}
+    {int i_=LOOPINIT(size); *r=i_; PUTSIZE(r,0); do r[i_] = 0; while (--i_ > 0);}
 #define INLINEset_fill(r, size)\
-    {int i_=LOOPINIT(size); *r=i_; \
-    r[i_]=((unsigned int)(~0))>>(i_*BPI-size); while(--i_>0) r[i_]=~0;}
+    {int i_=LOOPINIT(size); *r=i_; PUTSIZE(r,0); \
+    r[i_]=(~(set_word) 0)>>(i_*BPI-size); while(--i_>0) r[i_]=~(set_word) 0;}
 #define INLINEset_and(r, a, b)\
     {int i_=LOOP(a); PUTLOOP(r,i_);\
+    if (i_ >= set_vector.words) (*set_vector.set_and)(r, a, b, i_); else\
     do r[i_] = a[i_] & b[i_]; while (--i_>0);}
 #define INLINEset_or(r, a, b)\
     {int i_=LOOP(a); PUTLOOP(r,i_);\
+    if (i_ >= set_vector.words) (*set_vector.set_or)(r, a, b, i_); else\
     do r[i_] = a[i_] | b[i_]; while (--i_>0);}
 #define INLINEset_diff(r, a, b)\
     {int i_=LOOP(a); PUTLOOP(r,i_);\
+    if (i_ >= set_vector.words) (*set_vector.set_diff)(r, a, b, i_); else\
     do r[i_] = a[i_] & ~ b[i_]; while (--i_>0);}
 #define INLINEset_ndiff(r, a, b, fullset)\
     {int i_=LOOP(a); PUTLOOP(r,i_);\
@@ -217,18 +262,34 @@ typedef struct set_family {
     {int i_=LOOP(a); PUTLOOP(r,i_);\
     do r[i_] = (a[i_]&mask[i_]) | (b[i_]&~mask[i_]); while (--i_>0);}
 #define INLINEsetp_implies(a, b, when_false)\
-    {int i_=LOOP(a); do if (a[i_]&~b[i_]) break; while (--i_>0);\
+    {int i_=LOOP(a); if (i_ >= set_vector.words)\
+    i_ = ! (*set_vector.setp_implies)(a, b, i_); else\
+    do if (a[i_]&~b[i_]) break; while (--i_>0);\
     if (i_ != 0) when_false;}
 #define INLINEsetp_disjoint(a, b, when_false)\
-    {int i_=LOOP(a); do if (a[i_]&b[i_]) break; while (--i_>0);\
+    {int i_=LOOP(a); if (i_ >= set_vector.words)\
+    i_ = ! (*set_vector.setp_disjoint)(a, b, i_); else\
+    do if (a[i_]&b[i_]) break; while (--i_>0);\
     if (i_ != 0) when_false;}
 #define INLINEsetp_equal(a, b, when_false)\
-    {int i_=LOOP(a); do if (a[i_]!=b[i_]) break; while (--i_>0);\
+    {int i_=LOOP(a); if (i_ >= set_vector.words)\
+    i_ = ! (*set_vector.setp_equal)(a, b, i_); else\
+    do if (a[i_]!=b[i_]) break; while (--i_>0);\
     if (i_ != 0) when_false;}
 
 #endif
 
-#if BPI == 32
+#if BPI == 64
+#ifdef __GNUC__
+#define count_ones(v)   __builtin_popcountll(v)
+#else
+#define count_ones(v)\
+    (bit_count[v & 255] + bit_count[(v >> 8) & 255]\
+    + bit_count[(v >> 16) & 255] + bit_count[(v >> 24) & 255]\
+    + bit_count[(v >> 32) & 255] + bit_count[(v >> 40) & 255]\
+    + bit_count[(v >> 48) & 255] + bit_count[(v >> 56) & 255])
+#endif
+#elif BPI == 32
 #define count_ones(v)\
     (bit_count[v & 255] + bit_count[(v >> 8) & 255]\
     + bit_count[(v >> 16) & 255] + bit_count[(v >> 24) & 255])
@@ -236,6 +297,13 @@ typedef struct set_family {
 #define count_ones(v)   (bit_count[v & 255] + bit_count[(v >> 8) & 255])
 #endif
 
+/* Index of the lowest set bit of a nonzero word */
+#if BPI == 64 && defined(__GNUC__)
+#define first_one(v)    __builtin_ctzll(v)
+#else
+#define first_one(v)    bit_index(v)
+#endif
+
 /* Table for efficient bit counting */
 extern int bit_count[256];
 /*----- END OF set.h ----- */
@@ -254,7 +322,10 @@ extern int bit_count[256];
 #define pcover                  pset_family
 #define new_cover(i)            sf_new(i, cube.size)
 #define free_cover(r)           sf_free(r)
-#define free_cubelist(T)        delete(T[0]); delete(T);
+#define free_cubelist(T)        arena_free((void *) (T))
+#define new_scratch_cube()      set_clear((pcube) arena_alloc(\
+				    SET_SIZE(cube.size) * sizeof(set_word)), cube.size)
+#define free_scratch_cube(r)    arena_free((void *) (r))
 
 
 /* cost_t describes the cost of a cover */
@@ -337,6 +408,10 @@ typedef struct {
 #define DR_type (D_type | R_type)
 #define FDR_type (F_type | D_type | R_type)
 
+/* What read_binary_value() and friends found besides a value */
+#define TERM_SPACE	(-1)		/* a separator between values */
+#define TERM_BAD	(-2)		/* not a character of a term */
+
 /* Definitions for the debug variable */
 #define COMPL           0x0001
 #define ESSEN           0x0002
@@ -398,11 +473,11 @@ typedef struct {
     (is_in_set(c, cube.first_part[cube.output] + pos) != 0)
 
 #define PUTINPUT(c, pos, value)\
-    c[WHICH_WORD(2*pos)] = (c[WHICH_WORD(2*pos)] & ~(3 << WHICH_BIT(2*pos)))\
-		| (value << WHICH_BIT(2*pos))
+    c[WHICH_WORD(2*pos)] = (c[WHICH_WORD(2*pos)] & ~((set_word) 3 << WHICH_BIT(2*pos)))\
+		| ((set_word) (value) << WHICH_BIT(2*pos))
 #define PUTOUTPUT(c, pos, value)\
-    c[WHICH_WORD(pos)] = (c[WHICH_WORD(pos)] & (1 << WHICH_BIT(pos)))\
-		| (value << WHICH_BIT(pos))
+    c[WHICH_WORD(pos)] = (c[WHICH_WORD(pos)] & ((set_word) 1 << WHICH_BIT(pos)))\
+		| ((set_word) (value) << WHICH_BIT(pos))
 
 #define TWO     3
 #define DASH    3
@@ -424,29 +499,72 @@ typedef struct {
  *    Global Variable Declarations
  */
 
-extern unsigned int debug;              /* debug parameter */
-extern bool verbose_debug;              /* -v:  whether to print a lot */
+extern THREAD_LOCAL unsigned int debug;              /* debug parameter */
+extern THREAD_LOCAL bool verbose_debug;              /* -v:  whether to print a lot */
 extern const char *total_name[TIME_COUNT];    /* basic function names */
-extern std::chrono::duration<double> total_time[TIME_COUNT];     /* time spent in basic fcts */
-extern int total_calls[TIME_COUNT];     /* # calls to each fct */
-
-extern bool echo_comments;		/* turned off by -eat option */
-extern bool echo_unknown_commands;	/* always true ?? */
-extern bool force_irredundant;          /* -nirr command line option */
-extern bool skip_make_sparse;
-extern bool kiss;                       /* -kiss command line option */
-extern bool pos;                        /* -pos command line option */
-extern bool print_solution;             /* -x command line option */
-extern bool recompute_onset;            /* -onset command line option */
-extern bool remove_essential;           /* -ness command line option */
-extern bool single_expand;              /* -fast command line option */
-extern bool summary;                    /* -s command line option */
-extern bool trace;                      /* -t command line option */
-extern bool unwrap_onset;               /* -nunwrap command line option */
-extern bool use_random_order;		/* -random command line option */
-extern bool use_super_gasp;		/* -strong command line option */
-extern char *filename;			/* filename PLA was read from */
+extern THREAD_LOCAL double total_time[TIME_COUNT];     /* seconds spent in basic fcts */
+extern THREAD_LOCAL int total_calls[TIME_COUNT];     /* # calls to each fct */
+
+extern THREAD_LOCAL bool echo_comments;		/* turned off by -eat option */
+extern THREAD_LOCAL bool echo_unknown_commands;	/* always true ?? */
+extern THREAD_LOCAL bool force_irredundant;          /* -nirr command line option */
+extern THREAD_LOCAL bool skip_make_sparse;
+extern THREAD_LOCAL bool kiss;                       /* -kiss command line option */
+extern THREAD_LOCAL bool pos;                        /* -pos command line option */
+extern THREAD_LOCAL bool print_solution;             /* -x command line option */
+extern THREAD_LOCAL bool recompute_onset;            /* -onset command line option */
+extern THREAD_LOCAL bool remove_essential;           /* -ness command line option */
+extern THREAD_LOCAL bool single_expand;              /* -fast command line option */
+extern THREAD_LOCAL bool summary;                    /* -s command line option */
+extern THREAD_LOCAL bool trace;                      /* -t command line option */
+extern THREAD_LOCAL bool unwrap_onset;               /* -nunwrap command line option */
+extern THREAD_LOCAL bool use_random_order;		/* -random command line option */
+extern THREAD_LOCAL bool use_super_gasp;		/* -strong command line option */
+extern THREAD_LOCAL char *filename;			/* filename PLA was read from */
 extern bool debug_exact_minimization;   /* dumps info for -do exact */
+extern int num_threads;                 /* -j command line option */
+extern THREAD_LOCAL int use_huge_pages; /* -huge command line option */
+extern bool sf_keep_stats;              /* set.c: count for sf_print_stats() */
+extern THREAD_LOCAL long compl_cache_limit; /* -c: bytes for the complement cache */
+extern THREAD_LOCAL int reduce_mode;    /* -epreduce, -ejacobi */
+#define REDUCE_SEQUENTIAL	0	/* one cube after the other */
+#define REDUCE_PIPELINE		1	/* ahead on the pool, same cover */
+#define REDUCE_JACOBI		2	/* in rounds against the cover of the round */
+extern THREAD_LOCAL int irred_incremental_mode; /* turned off by -efullirr */
+extern THREAD_LOCAL int pass_memo_mode; /* turned off by -efullpass */
+
+
+/*
+ *  The thread pool (pool.c).  A task_group counts the tasks spawned into
+ *  it which have not finished yet; pool_wait() returns when it drops to 0.
+ */
+struct task_group {
+    std::atomic<int> pending;
+};
+extern THREAD_LOCAL struct cube_struct *pool_origin;	/* cube borrowed by a task */
+
+/*
+ *  A search (search.c) runs a loop of independent minimizations on the
+ *  pool and hands the results back in order; "best" holds the best cost
+ *  reported so far, so that candidates which cannot win may give up.
+ */
+typedef struct search_struct {
+    int n;				/* number of candidates */
+    void *(*run)(int i, void *arg);	/* candidate i, on any thread */
+    void (*done)(int i, void *result, void *arg);	/* in order, here */
+    void *arg;
+    std::atomic<long long> best;	/* see search_better() */
+} search_t, *psearch;
+
+/*
+ *  The key of a cube list in the complement cache (compl_cache.c): its
+ *  cofactor and its cubes, word for word
+ */
+typedef struct compl_key_struct {
+    unsigned long hash;
+    long nwords;
+    set_word *key;
+} compl_key_t;
 
 
 /*
@@ -481,7 +599,7 @@ struct cube_struct {
     pset *temp;                 /* an array of temporary sets */
     pset fullset;               /* a full cube */
     pset emptyset;              /* an empty cube */
-    unsigned int inmask;        /* mask to get odd word of binary part */
+    set_word inmask;            /* mask to get odd word of binary part */
     int inword;                 /* which word number for above */
     int *sparse;                /* should this variable be sparse? */
     int num_mv_vars;            /* number of multiple-valued variables */
@@ -500,13 +618,60 @@ struct cdata_struct {
 
 
 extern struct pla_types_struct pla_types[];
-extern struct cube_struct cube, temp_cube_save;
-extern struct cdata_struct cdata, temp_cdata_save;
+extern THREAD_LOCAL struct cube_struct cube, temp_cube_save;
+extern THREAD_LOCAL struct cdata_struct cdata, temp_cdata_save;
+
+
+/*
+ *  A minimizer context is the complete state of one minimization: the
+ *  cube structure, the scratch (cube.temp and cdata), the options and the
+ *  state kept from one call to the next.  The engine itself works on the
+ *  per-thread globals above; context_enter() installs a context on the
+ *  calling thread (saving what was there) and context_leave() puts it
+ *  back, so any number of contexts can be minimized at the same time,
+ *  one per thread.
+ */
+/*
+ *  The options of the engine which the tasks of the pool read as well:
+ *  pool_spawn() passes on the values of the spawning thread, and the
+ *  thread which runs the task installs them for the time of the task.
+ */
+struct engine_options {
+    int use_huge_pages;
+    int mincov_engine;
+    int mincov_lower_bound;
+    double mincov_time_budget;
+    long mincov_node_budget;
+    long compl_cache_limit;
+    int reduce_mode;
+    int irred_incremental_mode;
+    int pass_memo_mode;
+};
+
+typedef struct espresso_context {
+    struct cube_struct cube;
+    struct cdata_struct cdata;
+    struct set_vector_struct set_vector;
+    struct cube_struct *pool_origin;
+    unsigned int debug;
+    bool verbose_debug, trace, summary;
+    bool echo_comments, echo_unknown_commands, force_irredundant;
+    bool skip_make_sparse, kiss, pos, print_solution, recompute_onset;
+    bool remove_essential, single_expand, unwrap_onset, use_random_order;
+    bool use_super_gasp;
+    bool reduce_toggle;
+    struct engine_options engine;
+} espresso_context_t, *pcontext;
+
+extern THREAD_LOCAL bool reduce_toggle;	/* reduce.c: next cube order */
+extern THREAD_LOCAL std::ostream *espresso_out;	/* espresso.c: progress */
 
 #ifdef lint
 #define DISJOINT 0x5555
 #else
-#if BPI == 32
+#if BPI == 64
+#define DISJOINT 0x5555555555555555ULL
+#elif BPI == 32
 #define DISJOINT 0x55555555
 #else
 #define DISJOINT 0x5555
@@ -514,6 +679,8 @@ extern struct cdata_struct cdata, temp_cdata_save;
 #endif
 
 /* function declarations */
+/* arena.c */	extern void *arena_alloc(size_t nbytes);
+/* arena.c */	extern void arena_free(void *p);
 
 /* cofactor.c */	extern int binate_split_select(pcube * T, pcube cleft, pcube cright, int debug_flag);
 /* cofactor.c */	extern pcover cubeunlist(pcube * A1);
@@ -523,9 +690,15 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* cofactor.c */	extern pcube *cube3list(pcover A, pcover B, pcover C);
 /* cofactor.c */	extern pcube *scofactor(pcube * T, pcube c, int var);
 /* cofactor.c */	extern void massive_count(pcube * T);
+/* cofactor.c */	extern pcube *new_cubelist(int n);
 /* compl.c */	extern pcover complement(pcube * T);
 /* compl.c */	extern pcover simplify(pcube * T /* T will be disposed of */);
 /* compl.c */	extern void simp_comp(pcube * T /* T will be disposed of */, pcover * Tnew, pcover * Tbar);
+/* compl_cache.c */	extern pcover compl_cache_find(compl_key_t *k);
+/* compl_cache.c */	extern void compl_cache_clear();
+/* compl_cache.c */	extern void compl_cache_key(pcube *T, compl_key_t *k);
+/* compl_cache.c */	extern void compl_cache_print_stats();
+/* compl_cache.c */	extern void compl_cache_save(compl_key_t *k, pcover Tbar);
 /* contain.c */	extern int d1_rm_equal(pset *A1 /* array of set pointers */, int (*compare)(const void*, const void*) /* comparison function */);
 /* contain.c */	extern int rm2_contain(pset * A1 /* updated in place */, pset * B1 /* unchanged */);
 /* contain.c */	extern int rm2_equal(pset * A1, pset * B1 /* updated in place */, pset * E1, int (*compare)(const void*, const void*));
@@ -544,7 +717,22 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* contain.c */	extern pset_family sf_rev_contain(pset_family A /* disposes of A */);
 /* contain.c */	extern pset_family sf_union(pset_family A, pset_family B /* disposes of A and B */);
 /* contain.c */	extern pset_family sf_unlist(pset * A1, int totcnt, int size);
+/* context.c */	extern pcontext context_new();
+/* context.c */	extern void context_free(pcontext ctx);
+/* context.c */	extern void context_enter(pcontext ctx, pcontext save);
+/* context.c */	extern void context_leave(pcontext ctx, pcontext save);
+/* context.c */	extern void context_options(pcontext ctx);
+/* context.c */	extern void context_save(pcontext ctx);
+/* context.c */	extern void engine_options_save(struct engine_options *opt);
+/* context.c */	extern void engine_options_install(const struct engine_options *opt);
+/* context.c */	extern pcover context_espresso(pcontext ctx, pcover F, pcover D, pcover R);
+/* context.c */	extern pcover context_expand(pcontext ctx, pcover F, pcover R, bool nonsparse);
+/* context.c */	extern pcover context_reduce(pcontext ctx, pcover F, pcover D);
+/* context.c */	extern pcover context_irredundant(pcontext ctx, pcover F, pcover D);
+/* context.c */	extern pcover context_complement(pcontext ctx, pcube *T);
+/* context.c */	extern pcover context_minimize_exact(pcontext ctx, pcover F, pcover D, pcover R, int exact_cover);
 /* cubestr.c */	extern void cube_setup();
+/* cubestr.c */	extern void cube_share(struct cube_struct *from);
 /* cubestr.c */	extern void restore_cube_struct();
 /* cubestr.c */	extern void save_cube_struct();
 /* cubestr.c */	extern void setdown_cube();
@@ -558,7 +746,13 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* cvrin.c */	extern void free_PLA(pPLA PLA);
 /* cvrin.c */	extern void parse_pla();
 /* cvrin.c */	extern void read_cube();
+/* cvrin.c */	extern int read_binary_value(int ch, pcube cf, int var);
+/* cvrin.c */	extern int read_mv_value(int ch, pcube cf, int i);
+/* cvrin.c */	extern int read_output_value(int ch, int i, pcube cf, pcube cd, pcube cr, int type);
 /* cvrin.c */	extern void skip_line(std::istream& fpin, std::ostream& fpout, bool echo);
+/* cvrmap.c */	extern std::istream *pla_open(const char *fname);
+/* cvrmap.c */	extern std::streambuf *pla_mapped_buffer(std::istream& fp);
+/* cvrmap.c */	extern bool read_cube_mapped(std::streambuf *buf, pPLA PLA);
 /* cvrm.c */	extern void foreach_output_function(pPLA PLA, int (*func)(pPLA, int), int (*func1)(pPLA, int));
 /* cvrm.c */	extern int cubelist_partition(pcube *T,			/* a list of cubes */
                                               pcube **A, pcube **B,		/* cubelist of partition and remainder */
@@ -613,12 +807,14 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* equiv.c */	extern void find_equiv_outputs(pPLA PLA);
 /* equiv.c */	extern int check_equiv(pcover f1, pcover f2);
 /* espresso.c */	extern pcover espresso(pcover F, pcover D1, pcover R);
+/* espresso.c */	extern pcover espresso_search(pcover F, pcover D1, pcover R, psearch s, int candidate);
 /* essen.c */	extern bool essen_cube(pcover F, pcover D, pcube c);
 /* essen.c */	extern pcover cb_consensus(pcover T, pcube c);
 /* essen.c */	extern pcover cb_consensus_dist0(pcover R, pcube p, pcube c);
 /* essen.c */	extern pcover essential(pcover * Fp, pcover * Dp);
 /* exact.c */	extern pcover minimize_exact(pcover F, pcover D, pcover R, int exact_cover);
 /* exact.c */	extern pcover minimize_exact_literals(pcover F, pcover D, pcover R, int exact_cover);
+/* exact.c */	extern pcover minimize_exact_search(pcover F, pcover D, pcover R, int exact_cover, psearch s, int candidate);
 /* expand.c */	extern bool feasibly_covered(pcover BB, pcube c, pcube RAISE, pcube new_lower);
 /* expand.c */	extern int most_frequent(pcover CC, pcube FREESET);
 /* expand.c */	extern pcover all_primes(pcover F, pcover R);
@@ -640,6 +836,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* expand.c */	extern void mincov(pcover BB, pcube RAISE, pcube FREESET);
 /* expand.c */	extern void select_feasible(pcover BB, pcover CC, pcube RAISE, pcube FREESET, pcube SUPER_CUBE, int * num_covered);
 /* expand.c */	extern void setup_BB_CC(pcover BB, pcover CC);
+/* expand.c */	extern void expand_forget();
 /* gasp.c */	extern pcover expand_gasp();
 /* gasp.c */	extern pcover irred_gasp();
 /* gasp.c */	extern pcover last_gasp(pcover F, pcover D, pcover R, cost_t * cost);
@@ -670,6 +867,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* irred.c */	extern void mark_irredundant(pcover F, pcover D);
 /* irred.c */	extern void irred_split_cover(pcover F, pcover D, pcover * E, pcover * Rt, pcover * Rp);
 /* irred.c */	extern sm_matrix *irred_derive_table(pcover D, pcover E, pcover Rp);
+/* irred.c */	extern void irred_forget();
 /* map.c */	extern pset minterms();
 /* map.c */	extern void explode(int var, int z);
 /* map.c */	extern void map(pcover T);
@@ -700,6 +898,12 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* pair.c */	extern void find_optimal_pairing(pPLA PLA, int strategy);
 /* pair.c */	extern void set_pair(pPLA PLA);
 /* pair.c */	extern void set_pair1(pPLA PLA, bool adjust_labels);
+/* pool.c */	extern void pool_exit(int status);
+/* pool.c */	extern void pool_setup(int nthreads);
+/* pool.c */	extern void pool_setdown();
+/* pool.c */	extern int pool_threads();
+/* pool.c */	extern void pool_spawn(struct task_group *group, void (*fn)(void *), void *arg);
+/* pool.c */	extern void pool_wait(struct task_group *group);
 /* primes.c */	extern pcover primes_consensus(pcube * T /* T will be disposed of */);
 /* reduce.c */	extern bool sccc_special_cases(
                                                pcube *T,                 /* will be disposed if answer is determined */
@@ -709,6 +913,11 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* reduce.c */	extern pcube sccc(pcube * T /* T will be disposed of */);
 /* reduce.c */	extern pcube sccc_cube();
 /* reduce.c */	extern pcube sccc_merge(pcube left, pcube right, pcube cl, pcube cr);
+/* reduce.c */	extern void reduce_forget();
+/* search.c */	extern bool search_can_win(psearch s, int i, int lower_bound);
+/* search.c */	extern void search_better(psearch s, int i, int cost);
+/* search.c */	extern void search_init(psearch s, int n);
+/* search.c */	extern void search_run(psearch s);
 /* set.c */	extern bool set_andp(pset r, pset a, pset b);
 /* set.c */	extern bool set_orp();
 /* set.c */	extern bool setp_disjoint(pset a, pset b);
@@ -720,7 +929,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* set.c */	extern char *ps1(pset a);
 /* set.c */	extern int *sf_count(pset_family A);
 /* set.c */	extern int *sf_count_restricted(pset_family A, pset r);
-/* set.c */	extern int bit_index(unsigned int a);
+/* set.c */	extern int bit_index(set_word a);
 /* set.c */	extern int set_dist(pset a, pset b);
 /* set.c */	extern int set_ord(pset a);
 /* set.c */	extern void set_adjcnt(pset a, int * count, int weight);
@@ -732,6 +941,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* set.c */	extern pset set_merge(pset r, pset a, pset b, pset mask);
 /* set.c */	extern pset set_or(pset, pset, pset);
 /* set.c */	extern pset set_xor(pset, pset, pset);
+/* set.c */	extern pset sf_addroom(pset_family A);
 /* set.c */	extern pset sf_and();
 /* set.c */	extern pset sf_or();
 /* set.c */	extern pset_family sf_active(pset_family A);
@@ -757,6 +967,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* set.c */	extern void sf_delset(pset_family A, int i);
 /* set.c */	extern void sf_free(pset_family A);
 /* set.c */	extern void sf_print(pset_family A);
+/* set.c */	extern void sf_print_stats();
 /* set.c */	extern void sf_write();
 /* setc.c */	extern bool ccommon(pcube a, pcube b, pcube cof);
 /* setc.c */	extern bool cdist0(pcube a, pcube b);
@@ -774,6 +985,7 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* setc.c */	extern int lex_order1();
 /* setc.c */	extern pset force_lower(pset xlower, pset a, pset b);
 /* setc.c */	extern void consensus(pcube r, pcube a, pcube b);
+/* setv.c */	extern void set_vector_setup();
 /* sharp.c */	extern pcover cb1_dsharp();
 /* sharp.c */	extern pcover cb_dsharp(pcube c, pcover T);
 /* sharp.c */	extern pcover cb_recur_dsharp();
@@ -802,4 +1014,6 @@ extern struct cdata_struct cdata, temp_cdata_save;
 /* verify.c */	extern bool PLA_verify(pPLA PLA1, pPLA PLA2);
 /* verify.c */	extern bool check_consistency(pPLA PLA);
 /* verify.c */	extern bool verify(pcover F, pcover Fold, pcover Dold);
+/* verify.c */	extern bool verify_cover(pcover A, pcube *FD, const char *message);
+/* verify.c */	extern bool verify_minterm(pcube *FD, pcube c, pcube m);
 
@@ -3,6 +3,7 @@
     purpose: Find essential primes in a multiple-valued function
 */
 
+#include <algorithm>
 #include "espresso.h"
 
 /*
@@ -24,10 +25,168 @@
     on these primes for essentiality.
 */
 
-pcover essential(pcover * Fp, pcover * Dp)
+/*
+    The cubes of F u D are numbered once (F first, then D) and, for each
+    part, the set of cubes which contain it is kept as a bit column.  The
+    consensus for a prime c only needs the cubes at distance 0 or 1 from
+    c: a variable which is not full in c rules out the cubes missing from
+    the or of its columns, and the cubes ruled out by two variables are
+    dropped with a few word operations per variable.  The candidates are
+    then tested independently of one another (with -jN, as tasks of the
+    pool), and the results are applied in the order of F.
+*/
+#define ESSEN_MAX_WORDS		(1 << 24)	/* no bit columns if larger */
+#define ESSEN_TASK_CUBES	4		/* candidates per task */
+
+struct essen_index {
+    pcube *cube;			/* the cubes of F u D, by number */
+    int n;
+    pset *column;			/* cubes with part i, or NULL */
+    pset all;				/* cubes 0..n-1 */
+};
+
+struct essen_task {
+    struct essen_index *index;
+    pcover D;
+    pcube *cand;			/* the primes to test */
+    char *essen;			/* their results */
+    int count;
+};
+
+static void essen_index_setup(struct essen_index *index, pcover F, pcover D)
 {
     pcube last, p;
+    int i, k, n = F->count + D->count;
+
+    index->n = n;
+    index->cube = new pcube[n + 1];
+    k = 0;
+    foreach_set(F, last, p)
+	index->cube[k++] = p;
+    foreach_set(D, last, p)
+	index->cube[k++] = p;
+    index->all = set_full(n);
+
+    index->column = NULL;
+    if ((long) cube.size * SET_SIZE(n) > ESSEN_MAX_WORDS)
+	return;
+    index->column = new pset[cube.size];
+    for(i = 0; i < cube.size; i++)
+	index->column[i] = set_new(n);
+    for(k = 0; k < n; k++) {
+	p = index->cube[k];
+	for(i = 0; i < cube.size; i++)
+	    if (is_in_set(p, i))
+		set_insert(index->column[i], k);
+    }
+}
+
+static void essen_index_free(struct essen_index *index)
+{
+    int i;
+
+    if (index->column != NULL) {
+	for(i = 0; i < cube.size; i++)
+	    set_free(index->column[i]);
+	delete [] index->column;
+    }
+    set_free(index->all);
+    delete [] index->cube;
+}
+
+/* essen_near -- the cubes of the index at distance 0 or 1 from c */
+static pset essen_near(struct essen_index *index, pcube c, pset near)
+{
+    pset inter, miss, fail1, fail2;
+    int var, i, n = index->n;
+    bool full;
+
+    if (index->column == NULL)
+	return set_copy(near, index->all);
+
+    inter = set_new(n);
+    miss = set_new(n);
+    fail1 = set_new(n);
+    fail2 = set_new(n);
+    for(var = 0; var < cube.num_vars; var++) {
+	(void) set_clear(inter, n);
+	full = TRUE;
+	for(i = cube.first_part[var]; i <= cube.last_part[var]; i++) {
+	    if (is_in_set(c, i))
+		(void) set_or(inter, inter, index->column[i]);
+	    else
+		full = FALSE;
+	}
+	if (full)
+	    continue;			/* every cube meets c here */
+	(void) set_diff(miss, index->all, inter);
+	(void) set_and(inter, fail1, miss);
+	(void) set_or(fail2, fail2, inter);
+	(void) set_or(fail1, fail1, miss);
+    }
+    (void) set_diff(near, index->all, fail2);
+    set_free(inter);
+    set_free(miss);
+    set_free(fail1);
+    set_free(fail2);
+    return near;
+}
+
+/* essen_index_cube -- essen_cube() with the cubes of F u D from the index */
+static bool essen_index_cube(struct essen_index *index, pcover D, pcube c)
+{
+    pcover H;
+    pcube *H1, p, temp;
+    pset near;
+    int k;
+    bool essen;
+
+    near = essen_near(index, c, set_new(index->n));
+    H = new_cover(10);
+    temp = new_cube();
+    for(k = 0; k < index->n; k++) {
+	if (is_in_set(near, k)) {
+	    p = index->cube[k];
+	    switch (cdist01(p, c)) {
+		case 0:
+		    H = cb_consensus_dist0(H, p, c);
+		    break;
+		case 1:
+		    consensus(temp, p, c);
+		    H = sf_addset(H, temp);
+		    break;
+	    }
+	}
+    }
+    set_free(temp);
+    set_free(near);
+
+    /* Add the don't care set, and see if this covers c */
+    H1 = cube2list(H, D);
+    essen = ! cube_is_covered(H1, c);
+    free_cubelist(H1);
+    free_cover(H);
+    return essen;
+}
+
+static void essen_run(void *arg)
+{
+    struct essen_task *task = (struct essen_task *) arg;
+    int i;
+
+    for(i = 0; i < task->count; i++)
+	task->essen[i] = essen_index_cube(task->index, task->D, task->cand[i]);
+}
+
+pcover essential(pcover * Fp, pcover * Dp)
+{
+    pcube last, p, *cand;
     pcover E, F = *Fp, D = *Dp;
+    struct essen_index index;
+    struct essen_task *tasks;
+    struct task_group group;
+    char *essen;
+    int i, ncand, ntasks;
 
     /* set all cubes in F active */
     (void) sf_active(F);
@@ -35,29 +194,57 @@ pcover essential(pcover * Fp, pcover * Dp)
     /* Might as well start out with some cubes in E */
     E = new_cover(10);
 
+    /* don't test a prime which EXPAND says is nonessential, and only test
+       a prime which was relatively essential */
+    cand = new pcube[F->count + 1];
+    ncand = 0;
     foreach_set(F, last, p) {
-	/* don't test a prime which EXPAND says is nonessential */
-	if (! TESTP(p, NONESSEN)) {
-	    /* only test a prime which was relatively essential */
-	    if (TESTP(p, RELESSEN)) {
-		/* Check essentiality */
-		if (essen_cube(F, D, p)) {
-		    if (debug & ESSEN)
-			printf("ESSENTIAL: %s\n", pc1(p));
-		    E = sf_addset(E, p);
-		    RESET(p, ACTIVE);
-		    F->active_count--;
-		}
-	    }
+	if (! TESTP(p, NONESSEN) && TESTP(p, RELESSEN))
+	    cand[ncand++] = p;
+    }
+
+    /* Check essentiality */
+    essen = new char[ncand + 1];
+    if (ncand > 0) {
+	essen_index_setup(&index, F, D);
+	ntasks = (ncand + ESSEN_TASK_CUBES - 1) / ESSEN_TASK_CUBES;
+	tasks = new struct essen_task[ntasks];
+	group.pending = 0;
+	for(i = 0; i < ntasks; i++) {
+	    tasks[i].index = &index;
+	    tasks[i].D = D;
+	    tasks[i].cand = cand + i * ESSEN_TASK_CUBES;
+	    tasks[i].essen = essen + i * ESSEN_TASK_CUBES;
+	    tasks[i].count = std::min(ESSEN_TASK_CUBES, ncand - i * ESSEN_TASK_CUBES);
+	    if (pool_threads() > 1)
+		pool_spawn(&group, essen_run, (void *) &tasks[i]);
+	    else
+		essen_run((void *) &tasks[i]);
 	}
+	pool_wait(&group);
+	delete [] tasks;
+	essen_index_free(&index);
     }
 
+    for(i = 0; i < ncand; i++) {
+	if (essen[i]) {
+	    p = cand[i];
+	    if (debug & ESSEN)
+		printf("ESSENTIAL: %s\n", pc1(p));
+	    E = sf_addset(E, p);
+	    RESET(p, ACTIVE);
+	    F->active_count--;
+	}
+    }
+    delete [] essen;
+    delete [] cand;
+
     *Fp = sf_inactive(F);               /* delete the inactive cubes from F */
     *Dp = sf_join(D, E);		/* add the essentials to D */
     sf_free(D);
     return E;
 }
-
+
 /*
     essen_cube -- check if a single cube is essential or not
 
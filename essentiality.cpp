@@ -26,28 +26,28 @@ typedef struct {
     int free_count;
 } VAR;
 
-static int *c_free_list; /* List of raised variables  in cube c */
-static int c_free_count; /* active size of the above list */
+static THREAD_LOCAL int *c_free_list; /* List of raised variables  in cube c */
+static THREAD_LOCAL int c_free_count; /* active size of the above list */
 
-static int *r_free_list; /* List of subset of raised variables in cube c
+static THREAD_LOCAL int *r_free_list; /* List of subset of raised variables in cube c
 			which are raised in each cube of offset R */
-static int r_free_count; /* active size of the above list */
-static int r_head; /* current position in  the list above */
+static THREAD_LOCAL int r_free_count; /* active size of the above list */
+static THREAD_LOCAL int r_head; /* current position in  the list above */
 
-static int *reduced_c_free_list; /* c_free_list - r_free_list */
-static int reduced_c_free_count; /* active size of the above list */
+static THREAD_LOCAL int *reduced_c_free_list; /* c_free_list - r_free_list */
+static THREAD_LOCAL int reduced_c_free_count; /* active size of the above list */
 
-static VAR *unate_list; /* List of unate variables in the reduced_c_free_list */
-static int unate_count; /* active size of the above list */
+static THREAD_LOCAL VAR *unate_list; /* List of unate variables in the reduced_c_free_list */
+static THREAD_LOCAL int unate_count; /* active size of the above list */
 
-static VAR *binate_list; /* List of binate variables in the 
+static THREAD_LOCAL VAR *binate_list; /* List of binate variables in the 
 			 reduced_c_free_list */
-static int binate_count; /* active size of the above list */
+static THREAD_LOCAL int binate_count; /* active size of the above list */
 
-static int *variable_order; /* permutation of reduced c_free_count determining 
+static THREAD_LOCAL int *variable_order; /* permutation of reduced c_free_count determining 
 			    static ordering of variables */
-static int variable_count; /* active size of the above list */
-static int variable_head; /* current position in  the list above */
+static THREAD_LOCAL int variable_count; /* active size of the above list */
+static THREAD_LOCAL int variable_head; /* current position in  the list above */
 
 /* The passive size allocated on the first call to etr_order is equal
    to the number of binary variables */
@@ -77,7 +77,7 @@ pcover COVER; /* A global bag to collect the signature cubes in the cover
 pcover
 etr_order(pcover F,pcover E,pcover R,pcube c,pcube d)
 {
-	static int num_binary_vars;
+	static THREAD_LOCAL int num_binary_vars;
 	int v,e0,e1;
 	int i,free_var;
 	pcube lastr,r;
@@ -145,8 +145,8 @@ etr_order(pcover F,pcover E,pcover R,pcube c,pcube d)
 		odd_count = 0;
 		free_count = 0;
 		foreach_set(R,lastr,r){
-			odd = is_in_set(r,e0);
-			even = is_in_set(r,e1);
+			odd = is_in_set(r,e0) != 0;
+			even = is_in_set(r,e1) != 0;
 			if(odd && even){
 				free_count++;
 			}
@@ -3,7 +3,7 @@
 #include <fstream>
 
 static void dump_irredundant(pcover E, pcover Rt, pcover Rp, sm_matrix * table);
-static pcover do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted);
+static pcover do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted, psearch s, int candidate);
 
 
 /*
@@ -18,20 +18,35 @@ static pcover do_minimize(pcover F, pcover D, pcover R, int exact_cover, int wei
 pcover
 minimize_exact(pcover F, pcover D, pcover R, int exact_cover)
 {
-    return do_minimize(F, D, R, exact_cover, /*weighted*/ 0);
+    return do_minimize(F, D, R, exact_cover, /*weighted*/ 0, NULL, 0);
+}
+
+
+/*
+ *  minimize_exact_search -- minimize_exact() for candidate "candidate" of
+ *  the search "s"; returns NULL (and gives up before the covering step)
+ *  if the candidate cannot beat the best one found so far
+ */
+
+pcover
+minimize_exact_search(pcover F, pcover D, pcover R, int exact_cover,
+    psearch s, int candidate)
+{
+    return do_minimize(F, D, R, exact_cover, /*weighted*/ 0, s, candidate);
 }
 
 
 pcover
 minimize_exact_literals(pcover F, pcover D, pcover R, int exact_cover)
 {
-    return do_minimize(F, D, R, exact_cover, /*weighted*/ 1);
+    return do_minimize(F, D, R, exact_cover, /*weighted*/ 1, NULL, 0);
 }
 
 
 
 static pcover
-do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted)
+do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted,
+    psearch s, int candidate)
 {
     pcover newF, E, Rt, Rp;
     pset p, last;
@@ -39,6 +54,7 @@ do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted)
     sm_matrix *table;
     sm_row *cover;
     sm_element *pe;
+    mincov_outcome_t *outcome;
     int debug_save = debug;
 
     if (debug & EXACT) {
@@ -69,7 +85,28 @@ do_minimize(pcover F, pcover D, pcover R, int exact_cover, int weighted)
     } else {
 	weights = nullptr;
     }
+
+    /* Give up if this cannot beat the best candidate of the search */
+    if (s != NULL && ! search_can_win(s, candidate,
+	    E->count + sm_cover_lower_bound(table, weights))) {
+	if (weights != 0) {
+	    delete weights;
+	}
+	free_cover(E);
+	free_cover(Rt);
+	free_cover(Rp);
+	sm_free(table);
+	free_cover(F);
+	debug = debug_save;
+	return NULL;
+    }
     EXEC(cover=sm_minimum_cover(table,weights,heur,level), "MINCOV     ", F);
+    outcome = sm_minimum_cover_outcome();
+    if (! outcome->complete) {
+	*espresso_out << "# exact: budget spent after " << outcome->nodes <<
+	    " nodes, cover cost " << outcome->cost << ", lower bound " <<
+	    outcome->lower_bound << " (plus " << E->count << " essentials)\n";
+    }
     if (weights != 0) {
 	delete weights;
     }
@@ -29,8 +29,586 @@
 	starting the expansion
 */
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 #include "espresso.h"
+
+/*
+    The OFF-set index -- R sliced by parts
+
+    expand() keeps, for each part j, the set of cubes of R which contain
+    j (a column), and the set of cubes of R which are still active in
+    the blocking matrix; setup_BB_CC() resets the latter and every cube
+    deactivated below is removed from it along with its ACTIVE flag.
+    The distance of all active cubes to a cube r is then found one
+    variable at a time instead of one cube at a time: the cubes which
+    miss r in variable v are the active cubes outside the or of the
+    columns of the parts of r(v), and two running sets record the cubes
+    which miss r at least once and at least twice.  The parts forced low
+    by the cubes at distance 1 are the parts j of v which the cubes
+    missing r (only) in v contain.  A variable which is full in r is
+    never missed and is skipped.
+
+    essen_parts(), elim_lowering(), essen_raising() and feasibly_covered()
+    use the index when BB is the R it was built for, and give the same
+    answers as the loops over the cubes of BB, which they use otherwise.
+*/
+#define OFF_INDEX_MIN_CUBES	32		/* smaller R are scanned */
+#define OFF_INDEX_MAX_WORDS	(1 << 24)	/* larger indexes are not built */
+
+struct off_index {
+    pcover R;
+    int n;				/* cubes in R */
+    bool borrowed;			/* the columns belong to another index */
+    pset *column;			/* column[j]: the cubes with part j */
+    pset *miss;				/* miss[v]: the active cubes missing r in v */
+    pset all, active;
+    pset fail1, fail2, temp;		/* missing r in 1+ and 2+ variables */
+    pset *part;				/* the columns of r(v) */
+};
+
+static THREAD_LOCAL struct off_index *off_current = NULL;
+
+/* off_index_state -- allocate the sets which change with each use */
+static void off_index_state(struct off_index *x)
+{
+    int i, n = x->n;
+
+    x->miss = new pset[cube.num_vars];
+    for(i = 0; i < cube.num_vars; i++)
+	x->miss[i] = set_new(n);
+    x->all = set_full(n);
+    x->active = set_full(n);
+    x->fail1 = set_new(n);
+    x->fail2 = set_new(n);
+    x->temp = set_new(n);
+    x->part = new pset[cube.size];
+}
+
+static struct off_index *off_index_new(pcover R)
+{
+    struct off_index *x;
+    pcube p;
+    int i, k, n = R->count;
+
+    if (n < OFF_INDEX_MIN_CUBES ||
+	    (long) (cube.size + cube.num_vars) * SET_SIZE(n) > OFF_INDEX_MAX_WORDS)
+	return NULL;
+
+    x = new struct off_index;
+    x->R = R;
+    x->n = n;
+    x->borrowed = FALSE;
+    x->column = new pset[cube.size];
+    for(i = 0; i < cube.size; i++)
+	x->column[i] = set_new(n);
+    foreachi_set(R, k, p)
+	for(i = 0; i < cube.size; i++)
+	    if (is_in_set(p, i))
+		set_insert(x->column[i], k);
+    off_index_state(x);
+    return x;
+}
+
+/* off_index_share -- an index of R, a copy of x->R, with the columns of x */
+static struct off_index *off_index_share(struct off_index *x, pcover R)
+{
+    struct off_index *y;
+
+    if (x == NULL)
+	return NULL;
+    y = new struct off_index;
+    y->R = R;
+    y->n = x->n;
+    y->borrowed = TRUE;
+    y->column = x->column;
+    off_index_state(y);
+    return y;
+}
+
+static void off_index_free(struct off_index *x)
+{
+    int i;
+
+    if (x == NULL)
+	return;
+    if (! x->borrowed) {
+	for(i = 0; i < cube.size; i++)
+	    set_free(x->column[i]);
+	delete [] x->column;
+    }
+    for(i = 0; i < cube.num_vars; i++)
+	set_free(x->miss[i]);
+    delete [] x->miss;
+    set_free(x->all);
+    set_free(x->active);
+    set_free(x->fail1);
+    set_free(x->fail2);
+    set_free(x->temp);
+    delete [] x->part;
+    delete x;
+}
+
+/* off_index_for -- the index of BB, or NULL */
+static struct off_index *off_index_for(pcover BB)
+{
+    return off_current != NULL && off_current->R == BB ? off_current : NULL;
+}
+
+/* off_distance -- fail1, fail2 and miss[] of the active cubes against r */
+static void off_distance(struct off_index *x, pcube r)
+{
+    int var, i, k, w, nwords = LOOP(x->all);
+    pset *part = x->part, miss, fail1 = x->fail1, fail2 = x->fail2, active = x->active;
+    set_word meet, m;
+
+    (void) set_clear(fail1, x->n);
+    (void) set_clear(fail2, x->n);
+    for(var = 0; var < cube.num_vars; var++) {
+	miss = x->miss[var];
+	k = 0;
+	for(i = cube.first_part[var]; i <= cube.last_part[var]; i++)
+	    if (is_in_set(r, i))
+		part[k++] = x->column[i];
+	if (k == cube.part_size[var]) {
+	    (void) set_clear(miss, x->n);
+	    continue;			/* every cube meets r here */
+	}
+	for(w = 1; w <= nwords; w++) {
+	    meet = 0;
+	    for(i = 0; i < k; i++)
+		meet |= part[i][w];
+	    miss[w] = m = active[w] & ~meet;
+	    fail2[w] |= fail1[w] & m;
+	    fail1[w] |= m;
+	}
+    }
+}
+
+/* off_lower -- add the parts forced low by the cubes at distance 1 to xlower */
+static void off_lower(struct off_index *x, pcube r, pcube xlower)
+{
+    int var, i;
+    pset dist1 = x->temp;
+
+    for(var = 0; var < cube.num_vars; var++) {
+	if (setp_empty(x->miss[var]))
+	    continue;
+	(void) set_diff(dist1, x->miss[var], x->fail2);
+	if (setp_empty(dist1))
+	    continue;
+	for(i = cube.first_part[var]; i <= cube.last_part[var]; i++)
+	    if (! is_in_set(r, i) && ! setp_disjoint(x->column[i], dist1))
+		set_insert(xlower, i);
+    }
+}
+
+/* off_deactivate -- make the active cubes of 'gone' inactive in BB */
+static void off_deactivate(struct off_index *x, pcover BB, pset gone)
+{
+    int w, k;
+    set_word val;
+
+    for(w = 1; w <= LOOP(gone); w++)
+	for(val = gone[w] & x->active[w], k = (w-1) << LOGBPI; val != 0; k++, val >>= 1)
+	    if (val & 1) {
+		RESET(GETSET(BB, k), ACTIVE);
+		BB->active_count--;
+	    }
+    (void) set_diff(x->active, x->active, gone);
+}
+
+/*
+    Speculative expansion -- expand() with a thread pool
+
+    The expansion of a cube depends on the cubes of F before it only
+    through CC, the cubes which are neither PRIME nor COVERED when it is
+    expanded, and only through those of them inside its overexpanded
+    cube: essen_parts() leaves no other cube of CC active, and CC is not
+    read before.  expand_parallel() hands out the cubes in batches of
+    EXPAND_CHUNK_CUBES to each thread, and each task expands its cubes
+    in order on copies of F and R taken at the start of the batch, and
+    records the cubes it takes out of CC (the cube itself and those it
+    covers).  The results are then committed in the order of F: an
+    expansion stands if no cube inside its overexpanded cube left CC in
+    one of the two histories (the copy the task saw, and F as committed
+    so far) but not in the other; otherwise the cube is expanded again
+    against F, as expand() would.  The result is the cover expand()
+    computes without a pool.
+*/
+#define EXPAND_SPAWN_CUBES	256	/* smaller F are expanded in order */
+#define EXPAND_CHUNK_CUBES	16	/* cubes expanded ahead by each task */
+
+struct expand_chunk {
+    pcover S;				/* F at the start of the batch */
+    pcover F, R;			/* the copies the task works on */
+    struct off_index *index;		/* of R */
+    pcube INIT_LOWER, FREESET, SUPER_CUBE;
+    int first, last;			/* the cubes first..last-1 of F */
+    pcover raise, over;			/* RAISE, OVEREXPANDED_CUBE of each */
+    int *num_covered;
+    int *gone_start, *gone_end;		/* its part of gone, or -1 */
+    std::vector<int> gone;		/* the cubes taken out of CC */
+    char *covered;
+};
+
+/* expand_mark -- make p the prime RAISE, as expand() does */
+static void expand_mark(pcube p, pcube RAISE, pcube OVEREXPANDED_CUBE, int num_covered)
+{
+    (void) set_copy(p, RAISE);
+    SET(p, PRIME);
+    RESET(p, COVERED);		/* not really necessary */
+
+    /* See if we generated an inessential prime */
+    if (num_covered == 0 && ! setp_equal(p, OVEREXPANDED_CUBE)) {
+	SET(p, NONESSEN);
+    }
+}
+
+/* expand_chunk_run -- expand the cubes of a chunk on its copy of F */
+static void expand_chunk_run(void *arg)
+{
+    struct expand_chunk *c = (struct expand_chunk *) arg;
+    struct off_index *off_save = off_current;
+    pcube p, q;
+    int i, j, k;
+
+    off_current = c->index;
+    (void) sf_copy(c->F, c->S);
+    foreachi_set(c->F, j, q)
+	c->covered[j] = TESTP(q, COVERED) != 0;
+    c->gone.clear();
+    for(k = c->first; k < c->last; k++) {
+	i = k - c->first;
+	p = GETSET(c->F, k);
+	c->gone_start[i] = c->gone_end[i] = -1;
+	if (TESTP(p, PRIME) || TESTP(p, COVERED))
+	    continue;
+	c->gone_start[i] = c->gone.size();
+	expand1(c->R, c->F, GETSET(c->raise, i), c->FREESET, GETSET(c->over, i),
+	    c->SUPER_CUBE, c->INIT_LOWER, &c->num_covered[i], p);
+	expand_mark(p, GETSET(c->raise, i), GETSET(c->over, i), c->num_covered[i]);
+	c->gone.push_back(k);
+	foreachi_set(c->F, j, q)
+	    if (TESTP(q, COVERED) && ! c->covered[j]) {
+		c->covered[j] = 1;
+		c->gone.push_back(j);
+	    }
+	c->gone_end[i] = c->gone.size();
+    }
+    off_current = off_save;
+}
+
+/*
+ *  expand_valid -- the expansion of cube i of chunk c is the one expand()
+ *  would compute, given the cubes 'gone' out of CC in this batch so far
+ */
+static bool expand_valid(struct expand_chunk *c, int i, std::vector<int>& gone, int *mark, int *stamp)
+{
+    pcube over = GETSET(c->over, i);
+    int j, q, n = c->gone_start[i], seen = ++*stamp, both = ++*stamp;
+
+    for(j = 0; j < n; j++)
+	mark[c->gone[j]] = seen;
+    for(j = 0; j < (int) gone.size(); j++) {
+	q = gone[j];
+	if (mark[q] == seen)
+	    mark[q] = both;
+	else if (setp_implies(GETSET(c->S, q), over))
+	    return FALSE;
+    }
+    for(j = 0; j < n; j++) {
+	q = c->gone[j];
+	if (mark[q] == seen && setp_implies(GETSET(c->S, q), over))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/* expand_parallel -- the loop of expand() over F, on the thread pool */
+static void expand_parallel(pcover F, pcover R, pcube RAISE, pcube FREESET,
+    pcube OVEREXPANDED_CUBE, pcube SUPER_CUBE, pcube INIT_LOWER)
+{
+    int nchunks = pool_threads(), used, s, i, j, k, q, first, num_covered, stamp = 0;
+    struct expand_chunk *chunk = new struct expand_chunk[nchunks], *c;
+    struct task_group group;
+    std::vector<int> gone;
+    char *covered = new char[F->count]();
+    int *mark = new int[F->count]();
+    pcover S = sf_save(F);
+    pcube p, r;
+
+    for(s = 0; s < nchunks; s++) {
+	c = &chunk[s];
+	c->S = S;
+	c->F = sf_save(F);
+	c->R = sf_save(R);
+	c->index = off_index_share(off_current, c->R);
+	c->INIT_LOWER = INIT_LOWER;
+	c->FREESET = new_cube();
+	c->SUPER_CUBE = new_cube();
+	c->raise = new_cover(EXPAND_CHUNK_CUBES);
+	c->over = new_cover(EXPAND_CHUNK_CUBES);
+	c->num_covered = new int[EXPAND_CHUNK_CUBES];
+	c->gone_start = new int[EXPAND_CHUNK_CUBES];
+	c->gone_end = new int[EXPAND_CHUNK_CUBES];
+	c->covered = new char[F->count];
+    }
+
+    for(first = 0; first < F->count; first += nchunks * EXPAND_CHUNK_CUBES) {
+
+	/* Expand the cubes of the batch ahead, each chunk in order */
+	(void) sf_copy(S, F);
+	group.pending = 0;
+	for(used = 0; used < nchunks; used++) {
+	    c = &chunk[used];
+	    c->first = first + used * EXPAND_CHUNK_CUBES;
+	    c->last = std::min(F->count, c->first + EXPAND_CHUNK_CUBES);
+	    if (c->first >= c->last)
+		break;
+	    pool_spawn(&group, expand_chunk_run, c);
+	}
+	pool_wait(&group);
+
+	/* Commit them in order, or expand again what changed underneath */
+	gone.clear();
+	for(s = 0; s < used; s++) {
+	    c = &chunk[s];
+	    for(k = c->first; k < c->last; k++) {
+		i = k - c->first;
+		p = GETSET(F, k);
+		if (TESTP(p, PRIME) || TESTP(p, COVERED))
+		    continue;
+		if (c->gone_start[i] >= 0 && expand_valid(c, i, gone, mark, &stamp)) {
+		    for(j = c->gone_start[i]; j < c->gone_end[i]; j++) {
+			gone.push_back(q = c->gone[j]);
+			if (q != k) {
+			    SET(GETSET(F, q), COVERED);
+			    covered[q] = 1;
+			}
+		    }
+		    expand_mark(p, GETSET(c->raise, i), GETSET(c->over, i), c->num_covered[i]);
+		} else {
+		    expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+			INIT_LOWER, &num_covered, p);
+		    gone.push_back(k);
+		    foreachi_set(F, j, r)
+			if (TESTP(r, COVERED) && ! covered[j]) {
+			    covered[j] = 1;
+			    gone.push_back(j);
+			}
+		    expand_mark(p, RAISE, OVEREXPANDED_CUBE, num_covered);
+		}
+	    }
+	}
+    }
+
+    for(s = 0; s < nchunks; s++) {
+	c = &chunk[s];
+	free_cover(c->F);
+	free_cover(c->R);
+	off_index_free(c->index);
+	free_cube(c->FREESET);
+	free_cube(c->SUPER_CUBE);
+	free_cover(c->raise);
+	free_cover(c->over);
+	delete [] c->num_covered;
+	delete [] c->gone_start;
+	delete [] c->gone_end;
+	delete [] c->covered;
+    }
+    delete [] chunk;
+    delete [] covered;
+    delete [] mark;
+    free_cover(S);
+}
 
+/*
+    The expansions of expand() are kept per thread, for one R and
+    INIT_LOWER.  For the same reason as above, the expansion of c is a
+    function of c and of the cubes of CC inside its overexpanded cube, in
+    the order of F; the overexpanded cube itself depends on c and R only.
+    Each expansion is kept under c with its overexpanded cube, those
+    cubes of CC and which of them it covered, and is taken again when c
+    comes back and finds the same cubes of CC inside that cube.  In the
+    later passes of espresso() many reduced cubes come back this way.
+*/
+#define EXPAND_MEMO_BYTES	(16 << 20)	/* emptied when it grows past this */
+
+struct expand_kept {
+    std::vector<set_word> words;	/* c, OVEREXPANDED_CUBE, RAISE, then
+					   the cubes of CC inside */
+    std::vector<int> covered;		/* which of those it covered */
+    int num_covered;
+};
+
+struct expand_memo {
+    pcover R;				/* a copy of the OFF-set */
+    pcube INIT_LOWER;
+    std::vector<int> part_size;		/* the cube structure */
+    std::unordered_map<unsigned long, struct expand_kept> kept;
+    long bytes;
+};
+
+static THREAD_LOCAL struct expand_memo *expand_memo_current = NULL;
+
+/* expand_forget -- drop the expansions kept by expand() */
+void expand_forget()
+{
+    struct expand_memo *memo = expand_memo_current;
+
+    if (memo != NULL) {
+	free_cover(memo->R);
+	free_cube(memo->INIT_LOWER);
+	delete memo;
+	expand_memo_current = NULL;
+    }
+}
+
+/* expand_memo_for -- the memo of this thread for R and INIT_LOWER */
+static struct expand_memo *expand_memo_for(pcover R, pcube INIT_LOWER)
+{
+    struct expand_memo *memo = expand_memo_current;
+    int i, var;
+    bool same;
+
+    if (memo != NULL) {
+	same = memo->part_size.size() == (size_t) cube.num_vars &&
+	    memo->R->count == R->count && setp_equal(memo->INIT_LOWER, INIT_LOWER);
+	for(var = 0; same && var < cube.num_vars; var++)
+	    same = memo->part_size[var] == cube.part_size[var];
+	for(i = 0; same && i < R->count; i++)
+	    same = setp_equal(GETSET(memo->R, i), GETSET(R, i));
+	if (! same)
+	    expand_forget(), memo = NULL;
+    }
+    if (memo == NULL) {
+	memo = expand_memo_current = new expand_memo;
+	memo->R = sf_save(R);
+	memo->INIT_LOWER = set_save(INIT_LOWER);
+	memo->part_size.assign(cube.part_size, cube.part_size + cube.num_vars);
+	memo->bytes = 0;
+    }
+    if (memo->bytes > EXPAND_MEMO_BYTES) {
+	memo->kept.clear();
+	memo->bytes = 0;
+    }
+    return memo;
+}
+
+static unsigned long expand_hash(pcube c)
+{
+    unsigned long h = 14695981039346656037UL;
+    int i = LOOP(c);
+
+    do h = (h ^ c[i]) * 1099511628211UL; while (--i > 0);
+    return h;
+}
+
+/*
+ *  expand_reuse -- expand1() of c from the memo, FALSE if c is not kept
+ *  with the cubes of CC now inside its overexpanded cube
+ */
+static bool expand_reuse(struct expand_memo *memo, pcover F, pcube c,
+    pcube RAISE, pcube OVEREXPANDED_CUBE, int *num_covered)
+{
+    std::vector<pcube> inside;
+    pcube p, last;
+    int w = LOOP(c), k;
+
+    auto it = memo->kept.find(expand_hash(c));
+    if (it == memo->kept.end())
+	return FALSE;
+    struct expand_kept& e = it->second;
+    if (memcmp(&e.words[0], c + 1, w * sizeof(set_word)) != 0)
+	return FALSE;
+
+    /* the cubes of CC inside the overexpanded cube, as expand1() sees them */
+    (void) set_copy(OVEREXPANDED_CUBE, c);
+    memcpy(OVEREXPANDED_CUBE + 1, &e.words[w], w * sizeof(set_word));
+    k = 3*w;
+    foreach_set(F, last, p) {
+	if (p == c || TESTP(p, PRIME) || TESTP(p, COVERED) ||
+		! setp_implies(p, OVEREXPANDED_CUBE))
+	    continue;
+	if (k == (int) e.words.size() ||
+		memcmp(&e.words[k], p + 1, w * sizeof(set_word)) != 0)
+	    return FALSE;
+	inside.push_back(p);
+	k += w;
+    }
+    if (k != (int) e.words.size())
+	return FALSE;
+
+    SET(c, PRIME);
+    (void) set_copy(RAISE, c);
+    memcpy(RAISE + 1, &e.words[2*w], w * sizeof(set_word));
+    for(int i : e.covered)
+	SET(inside[i], COVERED);
+    *num_covered = e.num_covered;
+    return TRUE;
+}
+
+/* expand_keep -- keep the expansion of c; 'cc' were the cubes of CC before */
+static void expand_keep(struct expand_memo *memo, pcube c, std::vector<pcube>& cc,
+    pcube RAISE, pcube OVEREXPANDED_CUBE, int num_covered)
+{
+    struct expand_kept& e = memo->kept[expand_hash(c)];
+    int w = LOOP(c);
+
+    memo->bytes -= static_cast<long>(e.words.size() * sizeof(set_word));
+    e.words.assign(c + 1, c + w + 1);
+    e.words.insert(e.words.end(), OVEREXPANDED_CUBE + 1, OVEREXPANDED_CUBE + w + 1);
+    e.words.insert(e.words.end(), RAISE + 1, RAISE + w + 1);
+    e.covered.clear();
+    for(pcube p : cc) {
+	if (setp_implies(p, OVEREXPANDED_CUBE)) {
+	    if (TESTP(p, COVERED))
+		e.covered.push_back((int) (e.words.size() / w) - 3);
+	    e.words.insert(e.words.end(), p + 1, p + w + 1);
+	}
+    }
+    e.num_covered = num_covered;
+    memo->bytes += static_cast<long>(e.words.size() * sizeof(set_word));
+}
+
+/* expand_sequential -- expand the cubes of F in order, as expand() does */
+static void expand_sequential(pcover F, pcover R, pcube RAISE, pcube FREESET,
+    pcube OVEREXPANDED_CUBE, pcube SUPER_CUBE, pcube INIT_LOWER)
+{
+    struct expand_memo *memo;
+    std::vector<pcube> cc;
+    pcube last, p, last1, q;
+    int num_covered;
+
+    memo = pass_memo_mode && ! (debug & (EXPAND | EXPAND1)) ?
+	expand_memo_for(R, INIT_LOWER) : NULL;
+    foreach_set(F, last, p) {
+	/* do not expand if PRIME or if covered by previous expansion */
+	if (! TESTP(p, PRIME) && ! TESTP(p, COVERED)) {
+
+	    /* expand the cube p, result is RAISE */
+	    if (memo == NULL) {
+		expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+		    INIT_LOWER, &num_covered, p);
+	    } else if (! expand_reuse(memo, F, p, RAISE, OVEREXPANDED_CUBE,
+		    &num_covered)) {
+		cc.clear();
+		foreach_set(F, last1, q)
+		    if (q != p && ! TESTP(q, PRIME) && ! TESTP(q, COVERED))
+			cc.push_back(q);
+		expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+		    INIT_LOWER, &num_covered, p);
+		expand_keep(memo, p, cc, RAISE, OVEREXPANDED_CUBE, num_covered);
+	    }
+	    if (debug & EXPAND)
+		printf("EXPAND: %s (covered %d)\n", pc1(p), num_covered);
+	    expand_mark(p, RAISE, OVEREXPANDED_CUBE, num_covered);
+	}
+    }
+}
+
 /*
     expand -- expand each nonprime cube of F into a prime implicant
 
@@ -42,8 +620,9 @@ pcover expand(pcover F, pcover R, bool nonsparse  /* expand non-sparse variables
 {
     pcube last, p;
     pcube RAISE, FREESET, INIT_LOWER, SUPER_CUBE, OVEREXPANDED_CUBE;
-    int var, num_covered;
+    int var;
     bool change;
+    struct off_index *off_save = off_current;
 
     /* Order the cubes according to "chewing-away from the edges" of mini */
     if (use_random_order)
@@ -71,25 +650,17 @@ pcover expand(pcover F, pcover R, bool nonsparse  /* expand non-sparse variables
     }
 
     /* Try to expand each nonprime and noncovered cube */
-    foreach_set(F, last, p) {
-	/* do not expand if PRIME or if covered by previous expansion */
-	if (! TESTP(p, PRIME) && ! TESTP(p, COVERED)) {
-
-	    /* expand the cube p, result is RAISE */
-	    expand1(R, F, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
-		INIT_LOWER, &num_covered, p);
-	    if (debug & EXPAND)
-		printf("EXPAND: %s (covered %d)\n", pc1(p), num_covered);
-	    (void) set_copy(p, RAISE);
-	    SET(p, PRIME);
-	    RESET(p, COVERED);		/* not really necessary */
+    off_current = off_index_new(R);
+    if (pool_threads() > 1 && ! (debug & (EXPAND | EXPAND1)) &&
+	    F->count >= EXPAND_SPAWN_CUBES)
+	expand_parallel(F, R, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+	    INIT_LOWER);
+    else
+	expand_sequential(F, R, RAISE, FREESET, OVEREXPANDED_CUBE, SUPER_CUBE,
+	    INIT_LOWER);
 
-	    /* See if we generated an inessential prime */
-	    if (num_covered == 0 && ! setp_equal(p, OVEREXPANDED_CUBE)) {
-		SET(p, NONESSEN);
-	    }
-	}
-    }
+    off_index_free(off_current);
+    off_current = off_save;
 
     /* Delete any cubes of F which became covered during the expansion */
     F->active_count = 0;
@@ -178,6 +749,59 @@ pcube c			/* The cube to be expanded */)
     (void) set_or(RAISE, RAISE, FREESET);
 }
 
+/* essen_parts_scan -- essen_parts() for a BB without an index */
+static void essen_parts_scan(pcover BB, pcube r, pcube xlower)
+{
+    pcube p, lastp;
+    int dist;
+
+    foreach_active_set(BB, lastp, p) {
+#ifdef NO_INLINE
+	if ((dist = cdist01(p, r)) > 1) goto exit_if;
+#else
+	if (set_vector.cdist01 != NULL) {
+	    if ((dist = (*set_vector.cdist01)(p, r)) > 1) goto exit_if;
+	} else {
+	    int w, var, last;
+	    set_word x;
+	    pcube mask;
+
+	    dist = 0;
+	    if ((last = cube.inword) != -1) {
+		x = p[last] & r[last];
+		if ((x = ~(x | x >> 1) & cube.inmask))
+		    if ((dist = count_ones(x)) > 1)
+			goto exit_if;
+		for(w = 1; w < last; w++) {
+		    x = p[w] & r[w];
+		    if ((x = ~(x | x >> 1) & DISJOINT))
+			if (dist == 1 || (dist += count_ones(x)) > 1)
+			    goto exit_if;
+		}
+	    }
+	    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+		mask = cube.var_mask[var];
+		last = cube.last_word[var];
+		for(w = cube.first_word[var]; w <= last; w++)
+		    if (p[w] & r[w] & mask[w])
+			goto nextvar;
+		if (++dist > 1)
+		    goto exit_if;
+	    nextvar:;
+	    }
+	}
+#endif
+	if (dist == 0) {
+	    fatal("ON-set and OFF-set are not orthogonal");
+	} else {
+	    (void) force_lower(xlower, p, r);
+	    BB->active_count--;
+	    RESET(p, ACTIVE);
+	}
+exit_if: ;
+    }
+}
+
 /*
     essen_parts -- determine which parts are forced into the lowering
     set to insure that the cube be orthognal to the OFF-set.
@@ -193,32 +817,21 @@ pcube c			/* The cube to be expanded */)
 
 void essen_parts(pcover BB, pcover CC, pcube RAISE, pcube FREESET)
 {
-    pcube p, r = RAISE;
-    pcube lastp, xlower = cube.temp[0];
-    int dist;
+    pcube r = RAISE;
+    pcube xlower = cube.temp[0];
+    struct off_index *x;
 
     (void) set_copy(xlower, cube.emptyset);
 
-    foreach_active_set(BB, lastp, p) {
-#ifdef NO_INLINE
-	if ((dist = cdist01(p, r)) > 1) goto exit_if;
-#else
- {int w,last;unsigned int x;dist=0;if((last=cube.inword)!=-1)
-{x=p[last]&r[last];if((x=~(x|x>>1)&cube.inmask))if((dist=count_ones(x))>1)goto
-exit_if;for(w=1;w<last;w++){x=p[w]&r[w];if((x=~(x|x>>1)&DISJOINT))if(dist==1||(
-dist+=count_ones(x))>1)goto exit_if;}}}{int w,var,last;pcube
-mask;for(var=cube.num_binary_vars;var<cube.num_vars;var++){mask=cube.var_mask[
-var];last=cube.last_word[var];for(w=cube.first_word[var];w<=last;w++)if(p[w]&r[
-w]&mask[w])goto nextvar;if(++dist>1)goto exit_if;nextvar:;}}
-#endif
-	if (dist == 0) {
+    if ((x = off_index_for(BB)) != NULL) {
+	off_distance(x, r);
+	if (! setp_implies(x->active, x->fail1))
 	    fatal("ON-set and OFF-set are not orthogonal");
-	} else {
-	    (void) force_lower(xlower, p, r);
-	    BB->active_count--;
-	    RESET(p, ACTIVE);
-	}
-exit_if: ;
+	off_lower(x, r, xlower);
+	(void) set_diff(x->fail1, x->fail1, x->fail2);
+	off_deactivate(x, BB, x->fail1);
+    } else {
+	essen_parts_scan(BB, r, xlower);
     }
 
     if (! setp_empty(xlower)) {
@@ -241,12 +854,20 @@ exit_if: ;
 void essen_raising(pcover BB, pcube RAISE, pcube FREESET)
 {
     pcube last, p, xraise = cube.temp[0];
+    struct off_index *x;
+    int i;
 
     /* Form union of all cubes of BB, and then take complement wrt FREESET */
     (void) set_copy(xraise, cube.emptyset);
-    foreach_active_set(BB, last, p)
-	INLINEset_or(xraise, xraise, p);
-    (void) set_diff(xraise, FREESET, xraise);
+    if ((x = off_index_for(BB)) != NULL) {
+	for(i = 0; i < cube.size; i++)
+	    if (is_in_set(FREESET, i) && setp_disjoint(x->column[i], x->active))
+		set_insert(xraise, i);
+    } else {
+	foreach_active_set(BB, last, p)
+	    INLINEset_or(xraise, xraise, p);
+	(void) set_diff(xraise, FREESET, xraise);
+    }
 
     (void) set_or(RAISE, RAISE, xraise);         /* add to raising set */
     (void) set_diff(FREESET, FREESET, xraise);       /* remove from free set */
@@ -256,6 +877,50 @@ void essen_raising(pcover BB, pcube RAISE, pcube FREESET)
 	    pc1(RAISE), pc2(FREESET));
 }
 
+/* elim_lowering_scan -- the BB half of elim_lowering(), without an index */
+static void elim_lowering_scan(pcover BB, pcube r)
+{
+    pcube p, last;
+
+    foreach_active_set(BB, last, p) {
+#ifdef NO_INLINE
+	if (! cdist0(p, r))
+#else
+	if (set_vector.cdist0 != NULL) {
+	    if ((*set_vector.cdist0)(p, r))
+		continue;
+	} else {
+	    int w, var, lastw;
+	    set_word x;
+	    pcube mask;
+
+	    if ((lastw = cube.inword) != -1) {
+		x = p[lastw] & r[lastw];
+		if (~(x | x >> 1) & cube.inmask)
+		    goto false0;
+		for(w = 1; w < lastw; w++) {
+		    x = p[w] & r[w];
+		    if (~(x | x >> 1) & DISJOINT)
+			goto false0;
+		}
+	    }
+	    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+		mask = cube.var_mask[var];
+		lastw = cube.last_word[var];
+		for(w = cube.first_word[var]; w <= lastw; w++)
+		    if (p[w] & r[w] & mask[w])
+			goto nextvar;
+		goto false0;
+	    nextvar:;
+	    }
+	    continue;
+	}
+false0:
+#endif
+	    BB->active_count--, RESET(p, ACTIVE);
+    }
+}
+
 /*
     elim_lowering -- after removing parts from FREESET, we can reduce the
     size of both BB and CC.
@@ -269,22 +934,16 @@ void elim_lowering(pcover BB, pcover CC, pcube RAISE, pcube FREESET)
 {
     pcube p, r = set_or(cube.temp[0], RAISE, FREESET);
     pcube last;
+    struct off_index *x;
 
     /*
      *  Remove sets of BB which are orthogonal to future expansions
      */
-    foreach_active_set(BB, last, p) {
-#ifdef NO_INLINE
-	if (! cdist0(p, r))
-#else
- {int w,lastw;unsigned int x;if((lastw=cube.inword)!=-1){x=p[
-lastw]&r[lastw];if(~(x|x>>1)&cube.inmask)goto false0;for(w=1;w<lastw;w++){x=p[w]
-&r[w];if(~(x|x>>1)&DISJOINT)goto false0;}}}{int w,var,lastw;
-pcube mask;for(var=cube.num_binary_vars;var<cube.num_vars;var++){mask=cube.
-var_mask[var];lastw=cube.last_word[var];for(w=cube.first_word[var];w<=lastw;w++)
-if(p[w]&r[w]&mask[w])goto nextvar;goto false0;nextvar:;}}continue;false0:
-#endif
-	    BB->active_count--, RESET(p, ACTIVE);
+    if ((x = off_index_for(BB)) != NULL) {
+	off_distance(x, r);
+	off_deactivate(x, BB, x->fail1);
+    } else {
+	elim_lowering_scan(BB, r);
     }
 
 
@@ -351,11 +1010,14 @@ int most_frequent(pcover CC, pcube FREESET)
 void setup_BB_CC(pcover BB, pcover CC)
 {
     pcube p, last;
+    struct off_index *x;
 
     /* Create the block and cover set families */
     BB->active_count = BB->count;
     foreach_set(BB, last, p)
 	SET(p, ACTIVE);
+    if ((x = off_index_for(BB)) != NULL)
+	(void) set_copy(x->active, x->all);
 
     if (CC != (pcover) NULL) {
 	CC->active_count = CC->count;
@@ -480,32 +1142,47 @@ loop:
 /* NOTREACHED */
 }
 
-/*
-    feasibly_covered -- determine if the cube c is feasibly covered
-    (i.e., if it is possible to raise all of the necessary variables
-    while still insuring orthogonality with R).  Also, if c is feasibly
-    covered, then compute the new set of parts which are forced into
-    the lowering set.
-*/
-
-bool feasibly_covered(pcover BB, pcube c, pcube RAISE, pcube new_lower)
+/* feasibly_covered_scan -- feasibly_covered() for a BB without an index */
+static bool feasibly_covered_scan(pcover BB, pcube r, pcube new_lower)
 {
-    pcube p, r = set_or(cube.temp[0], RAISE, c);
+    pcube p, lastp;
     int dist;
-    pcube lastp;
 
-    set_copy(new_lower, cube.emptyset);
     foreach_active_set(BB, lastp, p) {
 #ifdef NO_INLINE
 	if ((dist = cdist01(p, r)) > 1) goto exit_if;
 #else
- {int w,last;unsigned int x;dist=0;if((last=cube.inword)!=-1)
-{x=p[last]&r[last];if((x=~(x|x>>1)&cube.inmask))if((dist=count_ones(x))>1)goto
-exit_if;for(w=1;w<last;w++){x=p[w]&r[w];if((x=~(x|x>>1)&DISJOINT))if(dist==1||(
-dist+=count_ones(x))>1)goto exit_if;}}}{int w,var,last;pcube
-mask;for(var=cube.num_binary_vars;var<cube.num_vars;var++){mask=cube.var_mask[
-var];last=cube.last_word[var];for(w=cube.first_word[var];w<=last;w++)if(p[w]&r[
-w]&mask[w])goto nextvar;if(++dist>1)goto exit_if;nextvar:;}}
+	if (set_vector.cdist01 != NULL) {
+	    if ((dist = (*set_vector.cdist01)(p, r)) > 1) goto exit_if;
+	} else {
+	    int w, var, last;
+	    set_word x;
+	    pcube mask;
+
+	    dist = 0;
+	    if ((last = cube.inword) != -1) {
+		x = p[last] & r[last];
+		if ((x = ~(x | x >> 1) & cube.inmask))
+		    if ((dist = count_ones(x)) > 1)
+			goto exit_if;
+		for(w = 1; w < last; w++) {
+		    x = p[w] & r[w];
+		    if ((x = ~(x | x >> 1) & DISJOINT))
+			if (dist == 1 || (dist += count_ones(x)) > 1)
+			    goto exit_if;
+		}
+	    }
+	    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+		mask = cube.var_mask[var];
+		last = cube.last_word[var];
+		for(w = cube.first_word[var]; w <= last; w++)
+		    if (p[w] & r[w] & mask[w])
+			goto nextvar;
+		if (++dist > 1)
+		    goto exit_if;
+	    nextvar:;
+	    }
+	}
 #endif
 	if (dist == 0)
 	    return FALSE;
@@ -515,6 +1192,30 @@ w]&mask[w])goto nextvar;if(++dist>1)goto exit_if;nextvar:;}}
     }
     return TRUE;
 }
+
+/*
+    feasibly_covered -- determine if the cube c is feasibly covered
+    (i.e., if it is possible to raise all of the necessary variables
+    while still insuring orthogonality with R).  Also, if c is feasibly
+    covered, then compute the new set of parts which are forced into
+    the lowering set.
+*/
+
+bool feasibly_covered(pcover BB, pcube c, pcube RAISE, pcube new_lower)
+{
+    pcube r = set_or(cube.temp[0], RAISE, c);
+    struct off_index *x;
+
+    set_copy(new_lower, cube.emptyset);
+    if ((x = off_index_for(BB)) != NULL) {
+	off_distance(x, r);
+	if (! setp_implies(x->active, x->fail1))
+	    return FALSE;
+	off_lower(x, r, new_lower);
+	return TRUE;
+    }
+    return feasibly_covered_scan(BB, r, new_lower);
+}
 
 /*
     mincov -- transform the problem of expanding a cube to a maximally-
@@ -4,28 +4,30 @@
  *    Global Variable Declarations
  */
 
-unsigned int debug;              /* debug parameter */
-bool verbose_debug;              /* -v:  whether to print a lot */
+THREAD_LOCAL unsigned int debug;              /* debug parameter */
+THREAD_LOCAL bool verbose_debug;              /* -v:  whether to print a lot */
 const char *total_name[TIME_COUNT];    /* basic function names */
-std::chrono::duration<double> total_time[TIME_COUNT];     /* time spent in basic fcts */
-int total_calls[TIME_COUNT];     /* # calls to each fct */
+THREAD_LOCAL double total_time[TIME_COUNT];     /* seconds spent in basic fcts */
+THREAD_LOCAL int total_calls[TIME_COUNT];     /* # calls to each fct */
 
-bool echo_comments;		 /* turned off by -eat option */
-bool echo_unknown_commands;	 /* always true ?? */
-bool force_irredundant;          /* -nirr command line option */
-bool skip_make_sparse;
-bool kiss;                       /* -kiss command line option */
-bool pos;                        /* -pos command line option */
-bool print_solution;             /* -x command line option */
-bool recompute_onset;            /* -onset command line option */
-bool remove_essential;           /* -ness command line option */
-bool single_expand;              /* -fast command line option */
-bool summary;                    /* -s command line option */
-bool trace;                      /* -t command line option */
-bool unwrap_onset;               /* -nunwrap command line option */
-bool use_random_order;		 /* -random command line option */
-bool use_super_gasp;		 /* -strong command line option */
-char *filename;			 /* filename PLA was read from */
+THREAD_LOCAL bool echo_comments;		 /* turned off by -eat option */
+THREAD_LOCAL bool echo_unknown_commands;	 /* always true ?? */
+THREAD_LOCAL bool force_irredundant;          /* -nirr command line option */
+THREAD_LOCAL bool skip_make_sparse;
+THREAD_LOCAL bool kiss;                       /* -kiss command line option */
+THREAD_LOCAL bool pos;                        /* -pos command line option */
+THREAD_LOCAL bool print_solution;             /* -x command line option */
+THREAD_LOCAL bool recompute_onset;            /* -onset command line option */
+THREAD_LOCAL bool remove_essential;           /* -ness command line option */
+THREAD_LOCAL bool single_expand;              /* -fast command line option */
+THREAD_LOCAL bool summary;                    /* -s command line option */
+THREAD_LOCAL bool trace;                      /* -t command line option */
+THREAD_LOCAL bool unwrap_onset;               /* -nunwrap command line option */
+THREAD_LOCAL bool use_random_order;		 /* -random command line option */
+THREAD_LOCAL bool use_super_gasp;		 /* -strong command line option */
+THREAD_LOCAL char *filename;			 /* filename PLA was read from */
+int num_threads;		 /* -j command line option */
+THREAD_LOCAL int use_huge_pages;	 /* -huge command line option */
 
 struct pla_types_struct pla_types[] = {
     "-f", F_type,
@@ -52,8 +54,8 @@ struct pla_types_struct pla_types[] = {
 };
 
 
-struct cube_struct cube, temp_cube_save;
-struct cdata_struct cdata, temp_cdata_save;
+THREAD_LOCAL struct cube_struct cube, temp_cube_save;
+THREAD_LOCAL struct cdata_struct cdata, temp_cdata_save;
 
 int bit_count[256] = {
   0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,1,2,2,3,2,3,3,4,2,3,3,4,3,4,4,5,
@@ -1,12 +1,21 @@
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 #include "espresso.h"
 #include <cassert>
 
+struct irred_delta;
+static sm_matrix *irred_incremental(pcover F, pcover D, pcover *E, pcover *Rt, pcover *Rp);
+static sm_matrix *irred_build_table(pcover D, pcover E, pcover Rp, struct irred_delta *delta);
 static void fcube_is_covered(pcube * T, pcube c, sm_matrix * table);
 static void ftautology(pcube * T /* T will be disposed of */, sm_matrix * table);
 static bool ftaut_special_cases(pcube * T /* will be disposed if answer is determined */, sm_matrix * table);
+static bool ptautology(pcube * T /* T will be disposed of */);
 
 
-static int Rp_current;
+static THREAD_LOCAL int Rp_current;
+
+THREAD_LOCAL int irred_incremental_mode = TRUE;	/* -efullirr turns it off */
 
 /*
  *   irredundant -- Return a minimal subset of F
@@ -34,8 +43,12 @@ mark_irredundant(pcover F, pcover D)
     sm_element *pe;
 
     /* extract a minimum cover */
-    irred_split_cover(F, D, &E, &Rt, &Rp);
-    table = irred_derive_table(D, E, Rp);
+    if (irred_incremental_mode && ! (debug & IRRED1)) {
+	table = irred_incremental(F, D, &E, &Rt, &Rp);
+    } else {
+	irred_split_cover(F, D, &E, &Rt, &Rp);
+	table = irred_derive_table(D, E, Rp);
+    }
     cover = sm_minimum_cover(table, nullptr, /* heuristic */ 1, /* debug */ 0);
 
     /* mark the cubes for the result */
@@ -137,10 +150,368 @@ irred_split_cover(pcover F, pcover D, pcover * E, pcover * Rt, pcover * Rp)
 
 sm_matrix *
 irred_derive_table(pcover D, pcover E, pcover Rp)
+{
+    return irred_build_table(D, E, Rp, NULL);
+}
+
+/*
+ *  The incremental engine.  Most cubes irredundant() is given were in the
+ *  cover of its previous call, and only the cubes moved by reduce() and
+ *  expand() are new.  Whether a cube is relatively essential depends only
+ *  on the cubes of F and D which meet it (its cofactor).  Whether a
+ *  redundant cube is totally or partially redundant depends on which of
+ *  those are essential, and its rows of the table on which of them are
+ *  essential, and which are partially redundant and come before it in F.
+ *  The answers of the last call are kept per thread, with the cubes they
+ *  were found for, and each answer is reused when nothing it depends on
+ *  has changed.  The table is the one irred_derive_table() would build.
+ */
+
+#define IRRED_E		0		/* relatively essential */
+#define IRRED_RT	1		/* totally redundant */
+#define IRRED_RP	2		/* partially redundant */
+
+struct irred_cube {
+    int cls;				/* IRRED_E, IRRED_RT or IRRED_RP */
+    std::vector<int> near;		/* cubes meeting it, F by number and
+					   D by -1-number, sorted */
+    std::vector<std::vector<int> > rows;	/* its rows of the table */
+};
+
+struct irred_memo {
+    pcover F, D;			/* the cover of the call */
+    std::vector<int> part_size;		/* and its cube structure */
+    std::vector<struct irred_cube> cube;
+};
+
+/* An irred_memo with how the cubes of this call map onto it */
+struct irred_delta {
+    struct irred_memo *last, *now;
+    std::vector<int> old;		/* the number in last->F of each cube */
+    std::vector<int> oldinv;		/* the cube with each number in last->F */
+    std::vector<bool> same;		/* meets the same cubes as then */
+};
+
+static THREAD_LOCAL struct irred_memo *irred_last = NULL;
+
+static void irred_memo_free(struct irred_memo *memo)
+{
+    free_cover(memo->F);
+    if (memo->D != NULL)
+	free_cover(memo->D);
+    delete memo;
+}
+
+/* irred_forget -- drop the answers kept by the incremental engine */
+void irred_forget()
+{
+    if (irred_last != NULL) {
+	irred_memo_free(irred_last);
+	irred_last = NULL;
+    }
+}
+
+static unsigned long irred_hash(pcube p)
+{
+    unsigned long h = 14695981039346656037UL;
+    int i = LOOP(p);
+
+    do h = (h ^ p[i]) * 1099511628211UL; while (--i > 0);
+    return h;
+}
+
+/* irred_same_cube -- TRUE if the cube structure is the one of 'memo' */
+static bool irred_same_cube(struct irred_memo *memo)
+{
+    int var;
+
+    if (memo->part_size.size() != (size_t) cube.num_vars)
+	return FALSE;
+    for(var = 0; var < cube.num_vars; var++)
+	if (memo->part_size[var] != cube.part_size[var])
+	    return FALSE;
+    return TRUE;
+}
+
+static bool irred_same_cover(pcover A, pcover B)
+{
+    int i;
+
+    if (A->count != B->count)
+	return FALSE;
+    for(i = 0; i < A->count; i++)
+	if (! setp_equal(GETSET(A, i), GETSET(B, i)))
+	    return FALSE;
+    return TRUE;
+}
+
+/* irred_match -- map the cubes of F onto those of the last call */
+static void irred_match(pcover F, struct irred_delta *delta)
+{
+    struct irred_memo *last = delta->last;
+    std::unordered_map<unsigned long, int> index;
+    pcube p;
+    int i, k;
+
+    index.reserve(last->F->count);
+    for(k = 0; k < last->F->count; k++) {
+	auto ins = index.emplace(irred_hash(GETSET(last->F, k)), k);
+	if (! ins.second)
+	    ins.first->second = -1;	/* duplicate or collision: never matched */
+    }
+    delta->oldinv.assign(last->F->count, -1);
+    for(i = 0; i < F->count; i++) {
+	p = GETSET(F, i);
+	auto it = index.find(irred_hash(p));
+	if (it != index.end() && (k = it->second) >= 0 &&
+		setp_equal(GETSET(last->F, k), p)) {
+	    delta->old[i] = k;
+	    delta->oldinv[k] = delta->oldinv[k] == -1 ? i : -2;
+	}
+    }
+
+    /* Cubes which appear twice in F are new */
+    for(i = 0; i < F->count; i++) {
+	if ((k = delta->old[i]) >= 0 && delta->oldinv[k] == -2)
+	    delta->old[i] = -1;
+    }
+    for(k = 0; k < last->F->count; k++) {
+	if (delta->oldinv[k] == -2)
+	    delta->oldinv[k] = -1;
+    }
+}
+
+/*
+ *  irred_near -- the cubes of F and D which meet each cube of F.  A cube
+ *  of the last call still meets the cubes it met then, so only the new
+ *  cubes are compared with the others, and a cube is the same if none of
+ *  the cubes it met has left F and no new cube meets it.
+ */
+static void irred_near(pcover F, pcover D, struct irred_delta *delta)
+{
+    std::vector<struct irred_cube>& cubes = delta->now->cube;
+    pcube p;
+    int i, j, n = F->count;
+
+    for(i = 0; i < n; i++) {
+	if (delta->old[i] < 0)
+	    continue;
+	delta->same[i] = TRUE;
+	for(int q : delta->last->cube[delta->old[i]].near) {
+	    if (q < 0) {
+		cubes[i].near.push_back(q);
+	    } else if ((j = delta->oldinv[q]) >= 0) {
+		cubes[i].near.push_back(j);
+	    } else {
+		delta->same[i] = FALSE;
+	    }
+	}
+    }
+
+    for(j = 0; j < n; j++) {
+	if (delta->old[j] >= 0)
+	    continue;
+	p = GETSET(F, j);
+	for(i = 0; i < n; i++) {
+	    if (i == j || (i < j && delta->old[i] < 0))
+		continue;		/* this pair was compared for cube i */
+	    if (cdist0(p, GETSET(F, i))) {
+		cubes[j].near.push_back(i);
+		cubes[i].near.push_back(j);
+		if (delta->old[i] >= 0)
+		    delta->same[i] = FALSE;
+	    }
+	}
+	for(i = 0; i < D->count; i++) {
+	    if (cdist0(p, GETSET(D, i))) {
+		cubes[j].near.push_back(-1-i);
+	    }
+	}
+    }
+
+    for(i = 0; i < n; i++) {
+	std::sort(cubes[i].near.begin(), cubes[i].near.end());
+    }
+}
+
+/*
+ *  irred_cofactor -- cofactor() of F and D against cube i of F, or of E
+ *  and D if 'essential', taken from the cubes which meet it
+ */
+static pcube *irred_cofactor(pcover F, pcover D, struct irred_delta *delta, int i, bool essential)
+{
+    std::vector<struct irred_cube>& cubes = delta->now->cube;
+    pcube *T, *T1;
+
+    T = T1 = new_cubelist(static_cast<int>(cubes[i].near.size()) + 3);
+    (void) set_diff(T[0], cube.fullset, GETSET(F, i));
+    T1 += 2;
+    for(int q : cubes[i].near) {
+	if (q < 0) {
+	    *T1++ = GETSET(D, -1-q);
+	} else if (! essential || cubes[q].cls == IRRED_E) {
+	    *T1++ = GETSET(F, q);
+	}
+    }
+    *T1++ = NULL;
+    T[1] = (pcube) T1;
+    return T;
+}
+
+/* irred_reuse_rows -- insert the rows of Rp_current from the last call */
+static bool irred_reuse_rows(struct irred_delta *delta, sm_matrix *table)
+{
+    struct irred_memo *last = delta->last;
+    int i = Rp_current, k = delta->old[i], j, rownum;
+    std::vector<std::vector<int> >& rows = delta->now->cube[i].rows;
+
+    if (! delta->same[i] || last->cube[k].cls != IRRED_RP)
+	return FALSE;
+    for(int q : delta->now->cube[i].near) {
+	if (q < 0)
+	    continue;
+	j = delta->old[q];
+	if (delta->now->cube[q].cls != last->cube[j].cls)
+	    return FALSE;
+	if (last->cube[j].cls == IRRED_RP && (q < i) != (j < k))
+	    return FALSE;
+    }
+
+    for(const std::vector<int>& row : last->cube[k].rows) {
+	rownum = table->last_row ? table->last_row->row_num+1 : 0;
+	rows.emplace_back();
+	for(int c : row) {
+	    (void) sm_insert(table, rownum, delta->oldinv[c]);
+	    rows.back().push_back(delta->oldinv[c]);
+	}
+    }
+    return TRUE;
+}
+
+/* irred_save_rows -- keep the rows of Rp_current from 'first' on */
+static void irred_save_rows(struct irred_delta *delta, sm_matrix *table, int first)
+{
+    std::vector<std::vector<int> >& rows = delta->now->cube[Rp_current].rows;
+    sm_row *prow;
+    sm_element *pe;
+    int r;
+
+    if (table->last_row == NULL)
+	return;
+    for(r = first; r <= table->last_row->row_num; r++) {
+	if ((prow = sm_get_row(table, r)) == NULL)
+	    continue;
+	rows.emplace_back();
+	sm_foreach_row_element(prow, pe) {
+	    rows.back().push_back(pe->col_num);
+	}
+    }
+}
+
+/*
+ *  irred_incremental -- irred_split_cover() and irred_derive_table(),
+ *  reusing what is still valid from the last call on this thread
+ */
+static sm_matrix *
+irred_incremental(pcover F, pcover D, pcover *E, pcover *Rt, pcover *Rp)
+{
+    struct irred_delta delta;
+    struct irred_memo *last, *now;
+    std::vector<struct irred_cube>& cubes = (now = new irred_memo)->cube;
+    pcube p, last1;
+    pcover R;
+    sm_matrix *table;
+    int i, n = F->count;
+
+    i = 0;
+    foreach_set(F, last1, p) {
+	PUTSIZE(p, i);
+	i++;
+    }
+
+    /* A task run while this call waits on the pool may call irredundant() */
+    last = irred_last;
+    irred_last = NULL;
+    if (last != NULL && (! irred_same_cube(last) || ! irred_same_cover(last->D, D))) {
+	irred_memo_free(last);
+	last = NULL;
+    }
+    delta.last = last;
+    delta.now = now;
+    delta.old.assign(n, -1);
+    delta.same.assign(n, FALSE);
+    if (last != NULL) {
+	irred_match(F, &delta);
+    }
+    cubes.resize(n);
+    irred_near(F, D, &delta);
+
+    /* Split F into E and R */
+    *E = new_cover(10);
+    *Rt = new_cover(10);
+    *Rp = new_cover(10);
+    R = new_cover(10);
+    foreach_set(F, last1, p) {
+	i = SIZE(p);
+	if (delta.same[i]) {
+	    cubes[i].cls = last->cube[delta.old[i]].cls;
+	} else {
+	    cubes[i].cls = tautology(irred_cofactor(F, D, &delta, i, FALSE)) ?
+		IRRED_RT : IRRED_E;
+	}
+	if (cubes[i].cls == IRRED_E) {
+	    *E = sf_addset(*E, p);
+	} else {
+	    R = sf_addset(R, p);
+	}
+    }
+
+    /* Split R into Rt and Rp */
+    foreach_set(R, last1, p) {
+	i = SIZE(p);
+	if (delta.same[i]) {
+	    for(int c : cubes[i].near) {
+		if (c >= 0 && (cubes[c].cls == IRRED_E) !=
+			(last->cube[delta.old[c]].cls == IRRED_E))
+		    goto split;
+	    }
+	    cubes[i].cls = last->cube[delta.old[i]].cls;
+	} else {
+split:	    cubes[i].cls = tautology(irred_cofactor(F, D, &delta, i, TRUE)) ?
+		IRRED_RT : IRRED_RP;
+	}
+	if (cubes[i].cls == IRRED_RT) {
+	    *Rt = sf_addset(*Rt, p);
+	} else {
+	    *Rp = sf_addset(*Rp, p);
+	}
+    }
+    free_cover(R);
+
+    table = irred_build_table(D, *E, *Rp, &delta);
+
+    /* Keep this call for the next one */
+    now->F = sf_save(F);
+    now->part_size.assign(cube.part_size, cube.part_size + cube.num_vars);
+    if (last != NULL) {
+	now->D = last->D;
+	last->D = NULL;
+	irred_memo_free(last);
+    } else {
+	now->D = sf_save(D);
+    }
+    irred_forget();
+    irred_last = now;
+    return table;
+}
+
+/* irred_build_table -- irred_derive_table(), incremental if 'delta' is given */
+static sm_matrix *
+irred_build_table(pcover D, pcover E, pcover Rp, struct irred_delta *delta)
 {
     pcube last, p, *list;
     sm_matrix *table;
-    int size_last_dominance, i;
+    int size_last_dominance, i, first;
 
     /* Mark each cube in DE as not part of the redundant set */
     foreach_set(D, last, p) {
@@ -162,7 +533,13 @@ irred_derive_table(pcover D, pcover E, pcover Rp)
     i = 0;
     foreach_set(Rp, last, p) {
 	Rp_current = SIZE(p);
-	fcube_is_covered(list, p, table);
+	if (delta == NULL) {
+	    fcube_is_covered(list, p, table);
+	} else if (! irred_reuse_rows(delta, table)) {
+	    first = table->last_row ? table->last_row->row_num+1 : 0;
+	    fcube_is_covered(list, p, table);
+	    irred_save_rows(delta, table, first);
+	}
 	RESET(p, REDUND);	/* can now consider this cube redundant */
 	if (debug & IRRED1) {
 	    (void) printf("IRRED1: %d of %d to-go=%d, table=%dx%d\n",
@@ -200,21 +577,25 @@ tautology(pcube * T /* T will be disposed of */)
 {
     pcube cl, cr;
     int best, result;
-    static int taut_level = 0;
+    static THREAD_LOCAL int taut_level = 0;
+
+    if (pool_threads() > 1 && ! (debug & TAUT)) {
+	return ptautology(T);
+    }
 
     if (debug & TAUT) {
 	debug_print(T, "TAUTOLOGY", taut_level++);
     }
 
     if ((result = taut_special_cases(T)) == MAYBE) {
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 	best = binate_split_select(T, cl, cr, TAUT);
 	result = tautology(scofactor(T, cl, best)) &&
 		 tautology(scofactor(T, cr, best));
 	free_cubelist(T);
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
     }
 
     if (debug & TAUT) {
@@ -223,6 +604,118 @@ tautology(pcube * T /* T will be disposed of */)
     return result;
 }
 
+/*
+ *  ptautology -- tautology() on the thread pool
+ *
+ *  The two cofactors of a split are independent: the right one is handed
+ *  to the pool while this thread recurses on the left one.  T is a
+ *  tautology only if every leaf of the recursion is, so the first leaf
+ *  which is not cancels the whole tree.  The component reduction in
+ *  taut_special_cases() or's two calls of tautology(); each of those
+ *  grows a tree of its own (which is cancelled along with its parent).
+ *
+ *  The tasks only read the cubes of T; the cofactors, cube.temp and cdata
+ *  are private to the thread running each task.  taut_tree_current is
+ *  set only while taut_special_cases() runs, to hand the tree to the
+ *  tautology() calls it makes: a thread waiting in pool_wait() may run
+ *  any other task, which must not take this tree as its parent.
+ */
+#define TAUT_SPAWN_CUBES	32	/* do not spawn for smaller cubelists */
+#define TAUT_SPAWN_DEPTH	24	/* ... nor below this level */
+
+struct taut_tree {
+    std::atomic<int> failed;		/* some leaf is not a tautology */
+    struct taut_tree *parent;
+};
+
+struct taut_task {
+    pcube *T;
+    struct taut_tree *tree;
+    int level;
+    bool result;
+};
+
+static THREAD_LOCAL struct taut_tree *taut_tree_current = NULL;
+
+static bool taut_cancelled(struct taut_tree *tree)
+{
+    for( ; tree != NULL; tree = tree->parent)
+	if (tree->failed.load(std::memory_order_relaxed))
+	    return TRUE;
+    return FALSE;
+}
+
+static bool taut_recur(pcube *T, struct taut_tree *tree, int level);
+
+static void taut_run(void *arg)
+{
+    struct taut_task *task = (struct taut_task *) arg;
+
+    task->result = taut_recur(task->T, task->tree, task->level);
+}
+
+static bool
+taut_recur(pcube *T, struct taut_tree *tree, int level)
+{
+    pcube cl, cr;
+    int best, result;
+    struct taut_task right;
+    struct task_group group;
+    struct taut_tree *save;
+
+    if (taut_cancelled(tree)) {
+	free_cubelist(T);
+	return FALSE;
+    }
+
+    save = taut_tree_current;
+    taut_tree_current = tree;
+    result = taut_special_cases(T);
+    taut_tree_current = save;
+    if (result == MAYBE) {
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
+	best = binate_split_select(T, cl, cr, TAUT);
+	if (level < TAUT_SPAWN_DEPTH && CUBELISTSIZE(T) >= TAUT_SPAWN_CUBES) {
+	    right.T = scofactor(T, cr, best);
+	    right.tree = tree;
+	    right.level = level + 1;
+	    right.result = FALSE;
+	    group.pending = 0;
+	    pool_spawn(&group, taut_run, &right);
+	    result = taut_recur(scofactor(T, cl, best), tree, level + 1);
+	    if (! result)
+		tree->failed = TRUE;
+	    pool_wait(&group);
+	    result = result && right.result;
+	} else {
+	    result = taut_recur(scofactor(T, cl, best), tree, level + 1) &&
+		     taut_recur(scofactor(T, cr, best), tree, level + 1);
+	}
+	free_cubelist(T);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
+    }
+
+    if (! result)
+	tree->failed = TRUE;
+    return result;
+}
+
+static bool
+ptautology(pcube * T /* T will be disposed of */)
+{
+    struct taut_tree tree;
+    bool result;
+
+    tree.failed = FALSE;
+    tree.parent = taut_tree_current;
+    taut_tree_current = NULL;
+    result = taut_recur(T, &tree, 0) && ! tree.failed;
+    taut_tree_current = tree.parent;
+    return result;
+}
+
 /*
  *  taut_special_cases -- check special cases for tautology
  */
@@ -324,23 +817,23 @@ ftautology(pcube * T /* T will be disposed of */, sm_matrix * table)
 {
     pcube cl, cr;
     int best;
-    static int ftaut_level = 0;
+    static THREAD_LOCAL int ftaut_level = 0;
 
     if (debug & TAUT) {
 	debug_print(T, "FIND_TAUTOLOGY", ftaut_level++);
     }
 
     if (ftaut_special_cases(T, table) == MAYBE) {
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 	best = binate_split_select(T, cl, cr, TAUT);
 
 	ftautology(scofactor(T, cl, best), table);
 	ftautology(scofactor(T, cr, best), table);
 
 	free_cubelist(T);
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
     }
 
     if (debug & TAUT) {
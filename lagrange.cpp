@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include "mincov_int.h"
+
+/*
+ *  lagrange.c -- a Lagrangian lower bound for the covering problem
+ *
+ *  Covering the rows with columns of least cost is
+ *
+ *	min c.x   subject to   A x >= 1,  x in {0,1}
+ *
+ *  Moving the rows into the objective with multipliers u >= 0 gives
+ *
+ *	L(u) = sum(i) u[i] + sum(j) min(0, c[j] - sum(i in column j) u[i])
+ *
+ *  and every L(u) is a lower bound on the cost of a cover.  The search
+ *  for good multipliers starts from u[i] = least c[j] / |column j| over
+ *  the row (which already makes L(u) = sum u[i]) and follows the
+ *  subgradient 1 - (columns with negative reduced cost in row i), with
+ *  the step of Held and Karp: lambda (target - L(u)) / |g|^2.  lambda is
+ *  halved whenever LAGRANGE_STALL steps in a row fail to raise the best
+ *  bound.  The target is the cost the cover must beat, or the cost of a
+ *  cover made from the columns of negative reduced cost, if lower.
+ *
+ *  The costs are integers, so the bound is rounded up.  The search stops
+ *  as soon as the bound reaches the target (the node is bounded), and
+ *  the arithmetic is done in the same order every time, so the bound
+ *  does not depend on the thread or the number of threads.
+ */
+
+#define LAGRANGE_ITERS		100	/* most steps at a node */
+#define LAGRANGE_STALL		5	/* steps without progress before halving */
+#define LAGRANGE_MIN_LAMBDA	0.005
+#define LAGRANGE_EPS		1e-6
+
+
+/* lagrange_bound -- a lower bound on the cost of covering 'L' */
+int
+lagrange_bound(lagrange_t * L, int target)
+{
+    double *u, *g, *rc;
+    double value, best, lambda, norm, step, goal;
+    int *len, *x;
+    int i, j, k, n, iter, stall, lb, cover, least;
+
+    if (L->nrows == 0) {
+	return 0;
+    }
+    u = new double[L->nrows];
+    g = new double[L->nrows];
+    rc = new double[L->ncols];
+    len = new int[L->ncols]();
+    x = new int[L->ncols];
+
+    for(k = 0; k < L->start[L->nrows]; k++) {
+	len[L->col[k]]++;
+    }
+    for(i = 0; i < L->nrows; i++) {
+	u[i] = -1.0;
+	for(k = L->start[i]; k < L->start[i+1]; k++) {
+	    j = L->col[k];
+	    if (u[i] < 0.0 || L->cost[j] < u[i] * len[j]) {
+		u[i] = (double) L->cost[j] / len[j];
+	    }
+	}
+    }
+
+    best = 0.0;
+    lb = 0;
+    lambda = 2.0;
+    stall = 0;
+    for(iter = 0; iter < LAGRANGE_ITERS; iter++) {
+
+	/* the reduced costs, L(u), and the columns it takes */
+	for(j = 0; j < L->ncols; j++) {
+	    rc[j] = L->cost[j];
+	}
+	value = 0.0;
+	for(i = 0; i < L->nrows; i++) {
+	    value += u[i];
+	    for(k = L->start[i]; k < L->start[i+1]; k++) {
+		rc[L->col[k]] -= u[i];
+	    }
+	}
+	cover = 0;
+	for(j = 0; j < L->ncols; j++) {
+	    x[j] = rc[j] < 0.0;
+	    if (x[j]) {
+		value += rc[j];
+		cover += L->cost[j];
+	    }
+	}
+
+	if (value > best + LAGRANGE_EPS) {
+	    best = value;
+	    stall = 0;
+	} else if (++stall >= LAGRANGE_STALL) {
+	    lambda /= 2.0;
+	    stall = 0;
+	}
+	lb = (int) ceil(best - LAGRANGE_EPS);
+	if (lb >= target || lambda < LAGRANGE_MIN_LAMBDA) {
+	    break;
+	}
+
+	/* the subgradient, and a cover for the target of the step */
+	norm = 0.0;
+	for(i = 0; i < L->nrows; i++) {
+	    n = 0;
+	    least = -1;
+	    for(k = L->start[i]; k < L->start[i+1]; k++) {
+		j = L->col[k];
+		n += x[j];
+		if (least < 0 || rc[j] < rc[least]) {
+		    least = j;
+		}
+	    }
+	    g[i] = 1.0 - n;
+	    if (g[i] < 0.0 && u[i] <= 0.0) {
+		g[i] = 0.0;		/* u[i] cannot go any lower */
+	    }
+	    norm += g[i] * g[i];
+	    if (n == 0) {
+		x[least] = 1;		/* later rows may share it */
+		cover += L->cost[least];
+	    }
+	}
+	goal = std::min(target, cover);
+	if (norm == 0.0 || goal - value < LAGRANGE_EPS) {
+	    break;			/* L(u) is the cost of a cover */
+	}
+
+	step = lambda * (goal - value) / norm;
+	for(i = 0; i < L->nrows; i++) {
+	    u[i] = std::max(0.0, u[i] + step * g[i]);
+	}
+    }
+
+    delete [] u;
+    delete [] g;
+    delete [] rc;
+    delete [] len;
+    delete [] x;
+    return lb;
+}
+
+/* sm_lagrange_bound -- lagrange_bound() of a sparse matrix */
+int
+sm_lagrange_bound(sm_matrix * A, int * weight, int target)
+{
+    lagrange_t L;
+    sm_row *prow;
+    sm_col *pcol;
+    sm_element *p;
+    int *index, i, k, lb;
+
+    L.nrows = A->nrows;
+    L.ncols = A->ncols;
+    L.start = new int[A->nrows + 1];
+    k = 0;
+    sm_foreach_row(A, prow) {
+	k += prow->length;
+    }
+    L.col = new int[k + 1];
+    L.cost = new int[A->ncols + 1];
+    index = new int[A->cols_size + 1];
+
+    i = 0;
+    sm_foreach_col(A, pcol) {
+	index[pcol->col_num] = i;
+	L.cost[i++] = WEIGHT(weight, pcol->col_num);
+    }
+    i = k = 0;
+    sm_foreach_row(A, prow) {
+	L.start[i++] = k;
+	sm_foreach_row_element(prow, p) {
+	    L.col[k++] = index[p->col_num];
+	}
+    }
+    L.start[i] = k;
+
+    lb = lagrange_bound(&L, target);
+    delete [] index;
+    delete [] L.start;
+    delete [] L.col;
+    delete [] L.cost;
+    return lb;
+}
@@ -13,6 +13,8 @@
  *  Old style -do xxx, -out xxx, etc. are still supported.
  */
 
+#include <deque>
+#include <sstream>
 #include "espresso.h"
 #include "main.h"		/* table definitions for options */
 #include <fstream>
@@ -26,6 +28,7 @@ void usage();
 void getPLA(int opt, int argc, char * argv[], int option, pPLA * PLA, int out_type);
 void delete_arg(int * argc, char * argv[], int num);
 bool check_arg(int * argc, char * argv[], const char * s);
+void many_espresso(pPLA PLA, int out_type);
 
 int main(int argc, char *argv[])
 {
@@ -35,6 +38,8 @@ int main(int argc, char *argv[])
     pset last1, p;
     cost_t cost;
     bool error, exact_cover;
+    double budget;
+    char *end;
     extern char *optarg;
     extern int optind;
 
@@ -68,12 +73,13 @@ int main(int argc, char *argv[])
     echo_comments = TRUE;
     echo_unknown_commands = TRUE;
     exact_cover = FALSE;	/* for -qm option, the default */
+    num_threads = 1;
 
     backward_compatibility_hack(&argc, argv, &option, &out_type);
 
 
     /* parse command line options*/
-    while ((i = getopt(argc, argv, "D:S:de:o:r:stv:x")) != EOF) {
+    while ((i = getopt(argc, argv, "D:S:b:c:de:j:o:r:stv:x")) != EOF) {
 	switch(i) {
 	    case 'D':		/* -Dcommand invokes a subcommand */
 		for(j = 0; option_table[j].name != 0; j++) {
@@ -142,6 +148,29 @@ int main(int argc, char *argv[])
 		trace = TRUE;
 		break;
 
+	    case 'b':		/* -bn: n seconds for an exact covering, -bnn: n nodes */
+		budget = strtod(optarg, &end);
+		if (end == optarg || budget < 0 ||
+			(strcmp(end, "") != 0 && strcmp(end, "n") != 0)) {
+		    fprintf(stderr, "%s: bad budget \"%s\"\n",
+			argv[0], optarg);
+		    exit(1);
+		}
+		if (*end == 'n') {
+		    mincov_node_budget = (long) budget;
+		} else {
+		    mincov_time_budget = budget;
+		}
+		break;
+
+	    case 'c':		/* -cn caches complements in up to n MB */
+		compl_cache_limit = atol(optarg) << 20;
+		break;
+
+	    case 'j':		/* -jn runs on n threads (0 = all cores) */
+		num_threads = atoi(optarg);
+		break;
+
 	    case 's':
 		summary = TRUE;
 		break;
@@ -168,6 +197,11 @@ int main(int argc, char *argv[])
 	}
     }
 
+    if (num_threads != 1) {
+	pool_setup(num_threads);
+    }
+    sf_keep_stats = summary;
+
     /* provide version information and summaries */
     if (summary || trace) {
 	/* echo command line and arguments */
@@ -229,7 +263,15 @@ int main(int argc, char *argv[])
 
     case KEY_MANY_ESPRESSO: {
 	int pla_type;
+	bool toggle = reduce_toggle, unwrap = unwrap_onset;
+	if (pool_threads() > 1 && ! debug && ! trace && ! summary) {
+	    many_espresso(PLA, out_type);
+	    exit(0);
+	}
 	do {
+	    /* each PLA starts afresh, as a run of its own would */
+	    reduce_toggle = toggle;
+	    unwrap_onset = unwrap;
 	    EXEC(PLA->F=espresso(PLA->F,PLA->D,PLA->R),"ESPRESSO   ",PLA->F);
 	    if (print_solution) {
             fprint_pla(std::cout, PLA, out_type);
@@ -512,6 +554,12 @@ int main(int argc, char *argv[])
     if (summary || trace) {
 	print_trace(PLA->F, option_table[option].name, ptime()-start);
     }
+    if (summary) {
+	sf_print_stats();
+	if (compl_cache_limit > 0) {
+	    compl_cache_print_stats();
+	}
+    }
 
     /* Output the solution */
     if (print_solution) {
@@ -548,7 +596,7 @@ void getPLA(int opt, int argc, char * argv[], int option, pPLA * PLA, int out_ty
 	if (strcmp(fname, "-") == 0) {
         fp= &std::cin;
     } else {
-        fp = new std::ifstream(argv[opt]);
+        fp = pla_open(argv[opt]);
         if (fp->bad()) {
             fprintf(stderr, "%s: Unable to open %s\n", argv[0], fname);
             exit(1);
@@ -575,6 +623,103 @@ void getPLA(int opt, int argc, char * argv[], int option, pPLA * PLA, int out_ty
 }
 
 
+/*
+ *  many_espresso -- the -Dmany loop, with the PLAs minimized on the pool
+ *
+ *  This thread reads the PLAs, hands each one (as a context) to a task
+ *  which minimizes it and prints the result into a buffer of its own,
+ *  and writes the buffers out in input order.  At most 2*pool_threads()
+ *  PLAs are in flight; while it waits for the oldest one, this thread
+ *  helps with the others, and sleeps in pool_wait() when there is
+ *  nothing left to help with.  The messages printed while reading a PLA go
+ *  into its buffer too, so the output is that of the sequential loop.
+ */
+struct many_job {
+    pcontext ctx;
+    pPLA PLA;
+    int out_type;
+    struct task_group group;
+    std::ostringstream out;
+};
+
+static void many_task(void *arg)
+{
+    struct many_job *job = (struct many_job *) arg;
+    std::ostream *out = espresso_out;
+    espresso_context_t save;
+
+    context_enter(job->ctx, &save);
+    espresso_out = &job->out;
+    job->PLA->F = espresso(job->PLA->F, job->PLA->D, job->PLA->R);
+    if (print_solution) {
+	fprint_pla(job->out, job->PLA, job->out_type);
+    }
+    free_PLA(job->PLA);
+    espresso_out = out;
+    context_leave(job->ctx, &save);
+    context_free(job->ctx);
+}
+
+/* many_write -- wait for the oldest PLA in flight and write it out */
+static void many_write(std::deque<struct many_job *> *window,
+    struct cube_struct *origin)
+{
+    struct many_job *job = window->front();
+    struct cube_struct *origin_save = pool_origin;
+
+    pool_origin = origin;
+    pool_wait(&job->group);
+    pool_origin = origin_save;
+    std::cout << job->out.str();
+    std::cout.flush();
+    window->pop_front();
+    delete job;
+}
+
+void many_espresso(pPLA PLA, int out_type)
+{
+    std::deque<struct many_job *> window;
+    struct many_job *job;
+    struct cube_struct origin, *origin_save = pool_origin;
+    std::ostream *out = espresso_out;
+    int pla_type;
+
+    job = new struct many_job;
+    job->ctx = context_new();
+    origin = cube;		/* the tasks' origin: sizes only, no sets */
+    for(;;) {
+	job->PLA = PLA;
+	job->out_type = out_type;
+	job->group.pending = 0;
+	pla_type = PLA->pla_type;
+	pool_origin = &origin;
+	pool_spawn(&job->group, many_task, (void *) job);
+	pool_origin = origin_save;
+	window.push_back(job);
+	if ((int) window.size() >= 2 * pool_threads()) {
+	    many_write(&window, &origin);
+	}
+
+	/* read the next PLA, printing into the buffer of its job */
+	job = new struct many_job;
+	espresso_out = &job->out;
+	if (read_pla(*last_fp, TRUE, TRUE, pla_type, &PLA) == EOF) {
+	    break;
+	}
+	espresso_out = out;
+	job->ctx = context_new();
+    }
+    espresso_out = out;
+
+    while (! window.empty()) {
+	many_write(&window, &origin);
+    }
+    std::cout << job->out.str();		/* trailing comments */
+    std::cout.flush();
+    delete job;
+}
+
+
 void init_runtime()
 {
     total_name[READ_TIME] =     "READ       ";
@@ -621,9 +766,13 @@ void usage()
     printf("  -d        Enable debugging\n");
     printf("  -e[opt]   Select espresso option:\n");
     printf("                fast, ness, nirr, nunwrap, onset, pos, strong,\n");
-    printf("                eat, eatdots, kiss, random\n");
+    printf("                eat, eatdots, kiss, random, huge, bitcov,\n");
+    printf("                lagrange, preduce, jacobi, fullirr, fullpass\n");
     printf("  -o[type]  Select output format:\n");
     printf("                f, fd, fr, fdr, pleasure, eqntott, kiss, cons\n");
+    printf("  -jn       Run on n threads (0 = one per core)\n");
+    printf("  -bn       Stop an exact covering after n seconds (-bnn: n nodes)\n");
+    printf("  -cn       Cache complements in up to n MB\n");
     printf("  -rn-m     Select range for subcommands:\n");
     printf("                d1merge: first and last variables (0 ... m-1)\n");
     printf("                minterms: first and last variables (0 ... m-1)\n");
@@ -99,15 +99,22 @@ struct {
     int *variable;
     int value;
 } esp_opt_table[] = {
+    "bitcov", &mincov_engine, MINCOV_BITS,
     "eat", &echo_comments, FALSE,
     "eatdots", &echo_unknown_commands, FALSE,
     "fast", &single_expand, TRUE,
+    "fullirr", &irred_incremental_mode, FALSE,
+    "fullpass", &pass_memo_mode, FALSE,
+    "huge", &use_huge_pages, TRUE,
+    "jacobi", &reduce_mode, REDUCE_JACOBI,
     "kiss", &kiss, TRUE,
+    "lagrange", &mincov_lower_bound, MINCOV_LAGRANGE,
     "ness", &remove_essential, FALSE,
     "nirr", &force_irredundant, FALSE,
     "nunwrap", &unwrap_onset, FALSE,
     "onset", &recompute_onset, TRUE,
     "pos", &pos, TRUE,
+    "preduce", &reduce_mode, REDUCE_PIPELINE,
     "random", &use_random_order, TRUE,
     "strong", &use_super_gasp, TRUE,
     0,
@@ -1,7 +1,7 @@
 #include "espresso.h"
 
-static pcube Gcube;
-static pset Gminterm;
+static THREAD_LOCAL pcube Gcube;
+static THREAD_LOCAL pset Gminterm;
 
 pset minterms(pcover T)
 {
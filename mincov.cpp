@@ -1,3 +1,4 @@
+#include "espresso.h"
 #include "mincov_int.h"
 
 /*
@@ -7,6 +8,51 @@
 #define USE_GIMPEL
 #define USE_INDEP_SET
 
+THREAD_LOCAL int mincov_engine = MINCOV_SPARSE;	/* -ebitcov: MINCOV_BITS */
+THREAD_LOCAL int mincov_lower_bound = MINCOV_INDEP;	/* -elagrange: MINCOV_LAGRANGE */
+THREAD_LOCAL double mincov_time_budget = 0.0;	/* -bn */
+THREAD_LOCAL long mincov_node_budget = 0;	/* -bnn */
+
+static THREAD_LOCAL mincov_outcome_t mincov_outcome;
+
+/*
+ *  The budget (-b)
+ *
+ *  With a budget of time or nodes, an exact covering runs as usual until
+ *  the budget is spent, and from then on each node takes the "accept
+ *  pick" branch only, as in a heuristic covering (a "reject pick" task
+ *  which has not started yet does nothing).  The search thus
+ *  completes the cover it is working on, returns the best cover found,
+ *  and reports with sm_minimum_cover_outcome() that it is not known to
+ *  be minimum; the lower bound is then the one of the root.
+ */
+
+/*
+ *  The parallel search (-jN)
+ *
+ *  The "reject pick" branch of a split is handed to the pool while this
+ *  thread takes the "accept pick" branch, and the two blocks of a
+ *  partition are solved at the same time, each as a covering problem of
+ *  its own.  The tasks of one covering problem share the best cover
+ *  found so far through an atomic key (cost, prefix): the prefix records
+ *  the first MINCOV_LEVELS branches on the way to the cover (accept = 0,
+ *  reject = 1, first branch in the high bit), so a smaller prefix means
+ *  earlier in the sequential search.  A node gives up when no cover below
+ *  it can have a smaller key.  Ties thus go to the cover the sequential
+ *  search would have found first, and the answer is the same with any
+ *  number of threads.  Below MINCOV_LEVELS no tasks are spawned, so all
+ *  the covers with the same prefix are found by one task, in order.
+ */
+struct mincov_task {
+    sm_matrix *A;
+    solution_t *select;
+    int *weight;
+    int lb, bound, depth;
+    stats_t stats;
+    struct mincov_search search;	/* for a block of a partition */
+    solution_t *best;
+};
+
 extern int select_column(sm_matrix * A, int * weight, solution_t * indep);
 extern void select_essential(sm_matrix * A, solution_t * select, int * weight, int bound /* must beat this solution */);
 extern int verify_cover(sm_matrix * A, sm_row * cover);
@@ -24,6 +70,8 @@ sm_minimum_cover(sm_matrix * A, int * weight,
                  int debug_level /* how deep in the recursion to provide info */)
 {
     stats_t stats;
+    struct mincov_search search;
+    struct mincov_budget budget;
     solution_t *best, *select;
     sm_row *prow, *sol;
     sm_col *pcol;
@@ -32,6 +80,8 @@ sm_minimum_cover(sm_matrix * A, int * weight,
     double sparsity;
 
     /* Avoid sillyness */
+    mincov_outcome.cost = mincov_outcome.lower_bound = mincov_outcome.nodes = 0;
+    mincov_outcome.complete = 1;
     if (A->nrows <= 0) {
 	return sm_row_alloc();		/* easy to cover */
     }
@@ -46,6 +96,24 @@ sm_minimum_cover(sm_matrix * A, int * weight,
     stats.gimpel = stats.gimpel_count = 0;
     stats.no_branching = heuristic != 0;
     stats.lower_bound = -1;
+    stats.indep_bound = -1;
+    stats.lagrange_count = stats.lagrange_gain = 0;
+    stats.search = nullptr;
+    stats.budget = nullptr;
+    stats.prefix = 0;
+    stats.level = 0;
+
+    /* Start the clock of the budget */
+    if (! stats.no_branching && (mincov_time_budget > 0 || mincov_node_budget > 0)) {
+	budget.nodes = 0;
+	budget.node_limit = mincov_node_budget;
+	budget.timed = mincov_time_budget > 0;
+	budget.deadline = std::chrono::steady_clock::now() +
+	    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(mincov_time_budget));
+	budget.spent = false;
+	stats.budget = &budget;
+    }
 
     /* Check the matrix sparsity */
     nelem = 0;
@@ -61,11 +129,20 @@ sm_minimum_cover(sm_matrix * A, int * weight,
     }
 
     /* Perform the covering */
-    select = solution_alloc();
-    dup_A = sm_dup(A);
-    best = sm_mincov(dup_A, select, weight, 0, bound, 0, &stats);
-    sm_free(dup_A);
-    solution_free(select);
+    if (pool_threads() > 1 && ! stats.debug) {
+	search.best = MINCOV_NONE;
+	search.gimpel = 0;
+	stats.search = &search;
+    }
+    if (mincov_engine == MINCOV_BITS) {
+	best = bm_minimum_cover(A, weight, bound, &stats);
+    } else {
+	select = solution_alloc();
+	dup_A = sm_dup(A);
+	best = sm_mincov(dup_A, select, weight, 0, bound, 0, &stats);
+	sm_free(dup_A);
+	solution_free(select);
+    }
 
     if (stats.debug) {
 	if (stats.no_branching) {
@@ -80,16 +157,362 @@ sm_minimum_cover(sm_matrix * A, int * weight,
 	(void) printf("gimpel     = %d\n", stats.gimpel_count);
 	(void) printf("nodes      = %d\n", stats.nodes);
 	(void) printf("max_depth  = %d\n", stats.max_depth);
+	if (stats.budget != nullptr) {
+	    (void) printf("budget     = %s\n",
+		budget.spent ? "spent, the cover may not be minimum" : "enough");
+	}
+	if (mincov_lower_bound == MINCOV_LAGRANGE) {
+	    (void) printf("lower bound = %d (independent set %d)\n",
+		stats.lower_bound, stats.indep_bound);
+	    (void) printf("lagrange   = %d nodes raised by %d\n",
+		stats.lagrange_count, stats.lagrange_gain);
+	}
     }
 
     sol = sm_row_dup(best->row);
     if (! verify_cover(A, sol)) {
 	fail("mincov: internal error -- cover verification failed\n");
     }
+    mincov_outcome.cost = best->cost;
+    mincov_outcome.nodes = stats.nodes;
+    if (stats.budget != nullptr && budget.spent) {
+	mincov_outcome.complete = 0;
+	mincov_outcome.lower_bound = std::max(stats.lower_bound, 0);
+    } else {
+	mincov_outcome.lower_bound = best->cost;
+    }
     solution_free(best);
     return sol;
 }
 
+/* sm_minimum_cover_outcome -- how the last sm_minimum_cover() of this thread ended */
+mincov_outcome_t *
+sm_minimum_cover_outcome()
+{
+    return &mincov_outcome;
+}
+
+/*
+ *  sm_cover_lower_bound -- no cover of 'A' costs less than this
+ *
+ *  The bound used at the root of sm_mincov(): the essential columns
+ *  plus an independent set of the rows which are left (or the
+ *  Lagrangian bound of those rows, if higher and -elagrange).
+ */
+int
+sm_cover_lower_bound(sm_matrix * A, int * weight)
+{
+    solution_t *select, *indep;
+    sm_matrix *dup_A;
+    sm_col *pcol;
+    int lb, bound;
+
+    if (A->nrows <= 0) {
+	return 0;
+    }
+    bound = 1;
+    sm_foreach_col(A, pcol) {
+	bound += WEIGHT(weight, pcol->col_num);
+    }
+    select = solution_alloc();
+    dup_A = sm_dup(A);
+    select_essential(dup_A, select, weight, bound);
+    indep = sm_maximal_independent_set(dup_A, weight);
+    lb = select->cost + indep->cost;
+    if (mincov_lower_bound == MINCOV_LAGRANGE) {
+	lb = std::max(lb, select->cost + sm_lagrange_bound(dup_A, weight, bound));
+    }
+    solution_free(indep);
+    sm_free(dup_A);
+    solution_free(select);
+    return lb;
+}
+
+/* mincov_bound -- tighten 'bound' with the best cover of the search */
+int
+mincov_bound(stats_t * stats, int bound)
+{
+    long long best;
+    int cost;
+
+    if (stats->search == nullptr) {
+	return bound;
+    }
+    best = stats->search->best.load(std::memory_order_relaxed);
+    if (best == MINCOV_NONE) {
+	return bound;
+    }
+    cost = (int) (best >> 32) - (stats->gimpel - stats->search->gimpel);
+    if ((best & 0xffffffffLL) > stats->prefix) {
+	cost++;			/* the same cost wins if it comes earlier */
+    }
+    return std::min(bound, cost);
+}
+
+/* mincov_better -- a cover of cost 'cost' was found at this node */
+void
+mincov_better(stats_t * stats, int cost)
+{
+    long long key, best;
+
+    if (stats->search == nullptr) {
+	return;
+    }
+    cost += stats->gimpel - stats->search->gimpel;
+    key = MINCOV_KEY(cost, stats->prefix);
+    best = stats->search->best.load();
+    while (key < best && ! stats->search->best.compare_exchange_weak(best, key))
+	;
+}
+
+/* mincov_fork -- statistics for a task, starting at this node */
+void
+mincov_fork(stats_t * to, stats_t * from)
+{
+    *to = *from;
+    to->max_depth = -1;
+    to->nodes = 0;
+    to->comp_count = 0;
+    to->gimpel_count = 0;
+    to->lagrange_count = 0;
+    to->lagrange_gain = 0;
+}
+
+/* mincov_join -- add the statistics of a finished task */
+void
+mincov_join(stats_t * to, stats_t * from)
+{
+    to->max_depth = std::max(to->max_depth, from->max_depth);
+    to->nodes += from->nodes;
+    to->comp_count += from->comp_count;
+    to->gimpel_count += from->gimpel_count;
+    to->lagrange_count += from->lagrange_count;
+    to->lagrange_gain += from->lagrange_gain;
+}
+
+/* mincov_node -- count a node of the search at 'depth' */
+void
+mincov_node(stats_t * stats, int depth)
+{
+    stats->nodes++;
+    if (depth > stats->max_depth) stats->max_depth = depth;
+    if (stats->budget != nullptr) {
+	stats->budget->nodes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/* mincov_stop -- take no more "reject pick" branches ? */
+int
+mincov_stop(stats_t * stats)
+{
+    struct mincov_budget *budget = stats->budget;
+
+    if (stats->no_branching) {
+	return 1;
+    }
+    if (budget == nullptr) {
+	return 0;
+    }
+    if (budget->spent.load(std::memory_order_relaxed)) {
+	return 1;
+    }
+    if ((budget->node_limit > 0 &&
+	    budget->nodes.load(std::memory_order_relaxed) >= budget->node_limit) ||
+	    (budget->timed && std::chrono::steady_clock::now() >= budget->deadline)) {
+	budget->spent = true;
+	return 1;
+    }
+    return 0;
+}
+
+/* mincov_lagrange -- raise the lower bound 'lb' of a node to 'lb_lagrange' */
+int
+mincov_lagrange(stats_t * stats, int lb, int lb_lagrange)
+{
+    if (lb_lagrange <= lb) {
+	return lb;
+    }
+    stats->lagrange_count++;
+    stats->lagrange_gain += lb_lagrange - lb;
+    return lb_lagrange;
+}
+
+/* mincov_new_search -- make 'stats' the root of a covering problem of its own */
+void
+mincov_new_search(stats_t * stats, struct mincov_search * search)
+{
+    search->best = MINCOV_NONE;
+    search->gimpel = stats->gimpel;
+    stats->search = search;
+    stats->prefix = 0;
+    stats->level = 0;
+}
+
+static void
+mincov_run(void * arg)
+{
+    struct mincov_task *t = (struct mincov_task *) arg;
+
+    t->best = sm_mincov(t->A, t->select, t->weight, t->lb, t->bound,
+			t->depth, &t->stats);
+}
+
+/* mincov_reject -- mincov_run() for a "reject pick" branch, unless out of budget */
+static void
+mincov_reject(void * arg)
+{
+    struct mincov_task *t = (struct mincov_task *) arg;
+
+    t->best = nullptr;
+    if (! mincov_stop(&t->stats)) {
+	mincov_run(arg);
+    }
+}
+
+/*
+ *  mincov_branch -- the split of sm_mincov() for a parallel search
+ *
+ *  Same as the sequential split below, except that the "reject" branch
+ *  runs as a task (near the root, for large enough matrices), and its
+ *  bound comes from the shared best cover rather than from best1.
+ */
+static solution_t *
+mincov_branch(sm_matrix * A, solution_t * select, int * weight, int pick,
+	      int lb, int bound, int depth, stats_t * stats)
+{
+    struct mincov_task reject;
+    struct task_group group;
+    sm_matrix *A1;
+    solution_t *select1, *best1, *best2;
+    long prefix = stats->prefix, bit;
+    int level = stats->level;
+    bool spawn;
+
+    bit = level < MINCOV_LEVELS ? 1L << (MINCOV_LEVELS - 1 - level) : 0;
+    spawn = level < MINCOV_LEVELS && A->nrows >= MINCOV_SPAWN_ROWS &&
+	    ! mincov_stop(stats);
+
+    /* Assume we cannot have that column (as a task) */
+    if (spawn) {
+	reject.A = sm_dup(A);
+	reject.select = solution_dup(select);
+	solution_reject(reject.select, reject.A, weight, pick);
+	reject.weight = weight;
+	reject.lb = lb;
+	reject.bound = bound;
+	reject.depth = depth + 1;
+	mincov_fork(&reject.stats, stats);
+	reject.stats.prefix = prefix | bit;
+	reject.stats.level = level + 1;
+	reject.best = nullptr;
+	group.pending = 0;
+	pool_spawn(&group, mincov_reject, (void *) &reject);
+    }
+
+    /* Assume we choose this column to be in the covering set */
+    A1 = sm_dup(A);
+    select1 = solution_dup(select);
+    solution_accept(select1, A1, weight, pick);
+    stats->level = level + 1;
+    best1 = sm_mincov(A1, select1, weight, lb, bound, depth+1, stats);
+    solution_free(select1);
+    sm_free(A1);
+
+    if (spawn) {
+	pool_wait(&group);
+	mincov_join(stats, &reject.stats);
+	solution_free(reject.select);
+	sm_free(reject.A);
+	best2 = reject.best;
+    } else if (mincov_stop(stats) || (best1 != nullptr && best1->cost == lb)) {
+	best2 = nullptr;
+    } else {
+	if (best1 != nullptr && bound > best1->cost) {
+	    bound = best1->cost;
+	}
+	A1 = sm_dup(A);
+	select1 = solution_dup(select);
+	solution_reject(select1, A1, weight, pick);
+	stats->prefix = prefix | bit;
+	best2 = sm_mincov(A1, select1, weight, lb, bound, depth+1, stats);
+	solution_free(select1);
+	sm_free(A1);
+    }
+    stats->prefix = prefix;
+    stats->level = level;
+
+    return solution_choose_best(best1, best2);
+}
+
+/*
+ *  mincov_blocks -- the partition of sm_mincov() for a parallel search
+ *
+ *  Each block is a covering problem of its own; R is solved by a task
+ *  while this thread solves L.  The sequential search solves R with the
+ *  cover of L already selected, which only tightens the bound, so the
+ *  cover of R is the same.
+ */
+static solution_t *
+mincov_blocks(sm_matrix * L, sm_matrix * R, solution_t * select, int * weight,
+	      int bound, int depth, stats_t * stats)
+{
+    struct mincov_task left, right;
+    struct task_group group;
+    solution_t *best;
+    sm_element *p;
+
+    right.A = R;
+    right.select = solution_alloc();
+    right.weight = weight;
+    right.lb = 0;
+    right.bound = bound - select->cost;
+    right.depth = depth + 1;
+    mincov_fork(&right.stats, stats);
+    mincov_new_search(&right.stats, &right.search);
+    right.best = nullptr;
+    group.pending = 0;
+    pool_spawn(&group, mincov_run, (void *) &right);
+
+    left.A = L;
+    left.select = solution_alloc();
+    left.weight = weight;
+    left.lb = 0;
+    left.bound = bound - select->cost;
+    left.depth = depth + 1;
+    mincov_fork(&left.stats, stats);
+    left.stats.component++;
+    mincov_new_search(&left.stats, &left.search);
+    mincov_run((void *) &left);
+
+    pool_wait(&group);
+    mincov_join(stats, &left.stats);
+    mincov_join(stats, &right.stats);
+    solution_free(left.select);
+    solution_free(right.select);
+    sm_free(L);
+    sm_free(R);
+
+    best = nullptr;
+    if (left.best != nullptr && right.best != nullptr) {
+	best = solution_dup(select);
+	for(p = left.best->row->first_col; p != 0; p = p->next_col) {
+	    solution_add(best, weight, p->col_num);
+	}
+	for(p = right.best->row->first_col; p != 0; p = p->next_col) {
+	    solution_add(best, weight, p->col_num);
+	}
+	if (best->cost >= bound) {
+	    solution_free(best);
+	    best = nullptr;
+	} else {
+	    mincov_better(stats, best->cost);
+	}
+    }
+    if (left.best != nullptr) solution_free(left.best);
+    if (right.best != nullptr) solution_free(right.best);
+    return best;
+}
+
 /*
  *  Find the best cover for 'A' (given that 'select' already selected);
  *
@@ -108,11 +531,11 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
     int pick, lb_new, debug;
 
     /* Start out with some debugging information */
-    stats->nodes++;
-    if (depth > stats->max_depth) stats->max_depth = depth;
+    mincov_node(stats, depth);
     debug = stats->debug && (depth <= stats->max_print_depth);
 
     /* Apply row dominance, column dominance, and select essentials */
+    bound = mincov_bound(stats, bound);
     select_essential(A, select, weight, bound);
     if (select->cost >= bound) {
 	return nullptr;
@@ -140,9 +563,19 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
     pick = select_column(A, weight, NIL(solution_t));
 #endif
 
+    /* Raise it with the Lagrangian bound, unless the node is bounded anyway */
+    if (depth == 0) {
+	stats->indep_bound = lb_new + stats->gimpel;
+    }
+    if (mincov_lower_bound == MINCOV_LAGRANGE && lb_new < bound && A->nrows > 0) {
+	lb_new = mincov_lagrange(stats, lb_new,
+	    select->cost + sm_lagrange_bound(A, weight, bound - select->cost));
+    }
+
     if (depth == 0) {
 	stats->lower_bound = lb_new + stats->gimpel;
     }
+    bound = mincov_bound(stats, bound);
 
     if (debug) {
         (void) printf("ABSMIN[%2d]%s", depth, stats->component ? "*" : " ");
@@ -160,6 +593,7 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
     /* Check for new best solution */
     } else if (A->nrows == 0) {
 	best = solution_dup(select);
+	mincov_better(stats, best->cost);
 	if (debug) (void) printf("BEST\n");
 	if (stats->debug && stats->component == 0) {
             (void) printf("new 'best' solution %d at level %d\n",
@@ -178,6 +612,10 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
 	if (debug) (void) printf("comp %d %d\n", L->nrows, R->nrows);
 	stats->comp_count++;
 
+	if (stats->search != nullptr) {
+	    return mincov_blocks(L, R, select, weight, bound, depth, stats);
+	}
+
 	/* Solve problem for L */
 	select1 = solution_alloc();
 	stats->component++;
@@ -202,6 +640,9 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
 	sm_free(R);
 
     /* We've tried as hard as possible, but now we must split and recur */
+    } else if (stats->search != nullptr) {
+	best = mincov_branch(A, select, weight, pick, lb_new, bound, depth, stats);
+
     } else {
 	if (debug) (void) printf("pick=%d\n", pick);
 
@@ -218,8 +659,8 @@ sm_mincov(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, i
 	    bound = best1->cost;
 	}
 
-	/* See if this is a heuristic covering (no branching) */
-	if (stats->no_branching) {
+	/* See if this is a heuristic covering (no branching), or out of budget */
+	if (mincov_stop(stats)) {
 	    return best1;
 	}
 
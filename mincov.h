@@ -1,4 +1,36 @@
+#ifndef MINCOV_H
+#define MINCOV_H
+
+#include "threadlocal.h"
+
 /* exported */
 extern sm_row *sm_minimum_cover(sm_matrix * A, int * weight,
                                 int heuristic /* set to 1 for a heuristic covering */,
                                 int debug_level /* how deep in the recursion to provide info */);
+extern int sm_cover_lower_bound(sm_matrix * A, int * weight);
+
+/* the engines of sm_minimum_cover() */
+#define MINCOV_SPARSE	0	/* sparse matrix, copied at each branch */
+#define MINCOV_BITS	1	/* bit matrix, changes undone (bitcov.c) */
+extern THREAD_LOCAL int mincov_engine;
+
+/* the lower bounds of sm_minimum_cover() */
+#define MINCOV_INDEP	0	/* maximal independent set of rows */
+#define MINCOV_LAGRANGE	1	/* also Lagrangian relaxation (lagrange.c) */
+extern THREAD_LOCAL int mincov_lower_bound;
+
+/* the budget of an exact sm_minimum_cover() (-b), 0 for none */
+extern THREAD_LOCAL double mincov_time_budget;	/* seconds of wall clock */
+extern THREAD_LOCAL long mincov_node_budget;	/* nodes of the search */
+
+/* how the last sm_minimum_cover() of this thread ended */
+typedef struct mincov_outcome_struct mincov_outcome_t;
+struct mincov_outcome_struct {
+    int cost;			/* cost of the cover returned */
+    int lower_bound;		/* no cover costs less */
+    int nodes;			/* nodes of the search */
+    int complete;		/* 0 if the budget stopped the search */
+};
+extern mincov_outcome_t *sm_minimum_cover_outcome();
+
+#endif
@@ -1,3 +1,5 @@
+#include <atomic>
+#include <chrono>
 #include "sparse.h"
 #include "mincov.h"
 
@@ -15,6 +17,13 @@ struct stats_struct {
     long start_time;		/* cpu time when the covering started */
     int no_branching;
     int lower_bound;
+    int indep_bound;		/* lower_bound before the Lagrangian bound */
+    int lagrange_count;		/* nodes where the Lagrangian bound was higher */
+    int lagrange_gain;		/* total it added to the lower bounds */
+    struct mincov_search *search; /* shared by the tasks of a parallel search */
+    struct mincov_budget *budget; /* shared by all the tasks, or nullptr */
+    long prefix;		/* branches taken so far (see mincov.c) */
+    int level;			/* number of branches taken */
 };
 
 
@@ -39,4 +48,48 @@ extern solution_t *sm_mincov(sm_matrix * A, solution_t * select, int * weight, i
 extern int gimpel_reduce(sm_matrix * A, solution_t * select, int * weight, int lb, int bound, int depth, stats_t * stats, solution_t ** best);
 
 
+/* the parallel search (mincov.c) */
+#define MINCOV_LEVELS		24
+#define MINCOV_SPAWN_ROWS	16	/* do not spawn for smaller matrices */
+#define MINCOV_KEY(cost, prefix) (((long long) (cost) << 32) | (long long) (prefix))
+#define MINCOV_NONE		0x7fffffffffffffffLL
+
+struct mincov_search {
+    std::atomic<long long> best;	/* key of the best cover so far */
+    int gimpel;				/* stats->gimpel at the root */
+};
+
+/* the budget of one covering problem (-b, mincov.c) */
+struct mincov_budget {
+    std::atomic<long> nodes;		/* nodes visited by all the tasks */
+    long node_limit;			/* 0 for none */
+    bool timed;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> spent;		/* some branch was left out */
+};
+
+extern int mincov_bound(stats_t * stats, int bound);
+extern void mincov_better(stats_t * stats, int cost);
+extern void mincov_fork(stats_t * to, stats_t * from);
+extern void mincov_join(stats_t * to, stats_t * from);
+extern int mincov_lagrange(stats_t * stats, int lb, int lb_lagrange);
+extern void mincov_node(stats_t * stats, int depth);
+extern int mincov_stop(stats_t * stats);
+extern void mincov_new_search(stats_t * stats, struct mincov_search * search);
+
+/* the bit matrix engine (bitcov.c) */
+extern solution_t *bm_minimum_cover(sm_matrix * A, int * weight, int bound, stats_t * stats);
+
+/* a covering problem by rows, for the Lagrangian bound (lagrange.c) */
+typedef struct lagrange_struct lagrange_t;
+struct lagrange_struct {
+    int nrows, ncols;
+    int *start;			/* row i is col[start[i]] .. col[start[i+1]-1] */
+    int *col;
+    int *cost;			/* cost of each column */
+};
+
+extern int lagrange_bound(lagrange_t * L, int target);
+extern int sm_lagrange_bound(sm_matrix * A, int * weight, int target);
+
 #define WEIGHT(weight, col)	(weight == nullptr ? 1 : weight[col])
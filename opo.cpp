@@ -47,9 +47,9 @@
  *  before.
  */
 
-static int opo_no_make_sparse;
-static int opo_repeated;
-static int opo_exact;
+static THREAD_LOCAL int opo_no_make_sparse;
+static THREAD_LOCAL int opo_repeated;
+static THREAD_LOCAL int opo_exact;
 void minimize(pPLA PLA);
 
 void phase_assignment(pPLA PLA, int opo_strategy)
@@ -151,13 +151,14 @@ pcube find_phase(pPLA PLA, int first_output, pcube phase1)
  *  primes.
  */
 
-/*ARGSUSED*/
 pcover opo(pcube phase, pcover T, pcover D, pcover R, int first_output)
 {
     int offset, output, i, last_output, ind;
     pset pdest, select, p, p1, last, last1, not_covered, tmp;
     pset_family temp, T1, T2;
 
+    (void) R;
+
     /* must select all primes for outputs [0 .. first_output-1] */
     select = set_full(T->count);
     for(output = 0; output < first_output; output++) {
@@ -218,7 +219,7 @@ pcover opo(pcube phase, pcover T, pcover D, pcover R, int first_output)
 
 pset_family opo_recur(pcover T, pcover D, pcube select, int offset, int first, int last)
 {
-    static int level = 0;
+    static THREAD_LOCAL int level = 0;
     int middle;
     pset_family sl, sr, temp;
 
@@ -508,11 +509,144 @@ pPLA set_phase(pPLA PLA)
 
 #define POW2(x)		(1 << (x))
 
+/* opoall_phase -- the phase assignment number "i" of opoall() */
+static pcube opoall_phase(int i, int first_output, int last_output)
+{
+    pcube phase;
+    int j, ind, num;
+
+    phase = set_save(cube.fullset);
+    num = i;
+    for(j = last_output; j >= first_output; j--) {
+	if (num % 2 == 0) {
+	    ind = cube.first_part[cube.output] + j;
+	    set_remove(phase, ind);
+	}
+	num /= 2;
+    }
+    return phase;
+}
+
+/*
+ *  opoall_parallel -- opoall() as a search on the thread pool (search.c)
+ *
+ *  Each phase assignment is a candidate.  With the exact strategy a
+ *  candidate gives up before the covering step when the lower bound of
+ *  its covering problem cannot beat the best phase found so far.
+ */
+struct opoall_search {
+    pPLA PLA;
+    int first_output, last_output, exact;
+    psearch s;
+    pcube bestphase;
+    pcover best_F, best_D, best_R;
+};
+
+static void *opoall_run(int i, void *arg)
+{
+    struct opoall_search *all = (struct opoall_search *) arg;
+    pPLA PLA1;
+    pcover F;
+
+    PLA1 = new_PLA();
+    PLA1->F = sf_save(all->PLA->F);
+    PLA1->D = sf_save(all->PLA->D);
+    PLA1->R = sf_save(all->PLA->R);
+    PLA1->phase = opoall_phase(i, all->first_output, all->last_output);
+
+    /* set the phase and minimize */
+    (void) set_phase(PLA1);
+    *espresso_out << "# phase is " << pc1(PLA1->phase) << "\n";
+    summary = TRUE;
+    opo_exact = all->exact;
+    if (opo_exact) {
+	const auto t = ptime();
+	F = minimize_exact_search(PLA1->F, PLA1->D, PLA1->R, 1, all->s, i);
+	if (F == NULL) {
+	    *espresso_out << "# EXACT\tcannot beat the best phase\n";
+	    free_PLA(PLA1);
+	    return NULL;
+	}
+	free_cover(PLA1->F);
+	PLA1->F = F;
+	print_trace(PLA1->F, "EXACT", ptime() - t);
+    } else {
+	const auto t = ptime();
+	F = espresso_search(PLA1->F, PLA1->D, PLA1->R, all->s, i);
+	if (F == NULL) {
+	    *espresso_out << "# ESPRESSO\tcannot beat the best phase\n";
+	    PLA1->F = NULL;
+	    free_PLA(PLA1);
+	    return NULL;
+	}
+	PLA1->F = F;
+	print_trace(PLA1->F, "ESPRESSO  ", ptime() - t);
+    }
+    search_better(all->s, i, PLA1->F->count);
+    return (void *) PLA1;
+}
+
+static void opoall_done(int i, void *result, void *arg)
+{
+    struct opoall_search *all = (struct opoall_search *) arg;
+    pPLA PLA1 = (pPLA) result;
+
+    (void) i;
+
+    /* see if this is the best so far */
+    if (PLA1 == NULL) {
+	return;
+    }
+    if (PLA1->F->count < all->best_F->count) {
+	set_copy(all->bestphase, PLA1->phase);
+	sf_free(all->best_F);
+	sf_free(all->best_D);
+	sf_free(all->best_R);
+	all->best_F = PLA1->F;
+	all->best_D = PLA1->D;
+	all->best_R = PLA1->R;
+	PLA1->F = PLA1->D = PLA1->R = NULL;
+    }
+    free_PLA(PLA1);
+}
+
+static void opoall_parallel(pPLA PLA, int first_output, int last_output,
+    pcube bestphase, pcover *best_F, pcover *best_D, pcover *best_R)
+{
+    struct opoall_search all;
+    search_t s;
+
+    all.PLA = PLA;
+    all.first_output = first_output;
+    all.last_output = last_output;
+    all.exact = opo_exact;
+    all.s = &s;
+    all.bestphase = bestphase;
+    all.best_F = *best_F;
+    all.best_D = *best_D;
+    all.best_R = *best_R;
+
+    search_init(&s, POW2(last_output - first_output + 1));
+    s.run = opoall_run;
+    s.done = opoall_done;
+    s.arg = (void *) &all;
+    search_better(&s, -1, all.best_F->count);
+    search_run(&s);
+    if (s.n > 0) {
+	summary = TRUE;				/* as opoall_run() left it */
+    }
+
+    *best_F = all.best_F;
+    *best_D = all.best_D;
+    *best_R = all.best_R;
+}
+
 void opoall(pPLA PLA, int first_output, int last_output, int opo_strategy)
 {
     pcover F, D, R, best_F, best_D, best_R;
-    int i, j, ind, num;
+    int i;
     pcube bestphase;
+    bool toggle = reduce_toggle, unwrap = unwrap_onset;
 
     opo_exact = opo_strategy;
 
@@ -525,52 +659,55 @@ void opoall(pPLA PLA, int first_output, int last_output, int opo_strategy)
     best_D = sf_save(PLA->D);
     best_R = sf_save(PLA->R);
 
-    for(i = 0; i < POW2(last_output - first_output + 1); i++) {
-
-	/* save the initial PLA covers */
-	F = sf_save(PLA->F);
-	D = sf_save(PLA->D);
-	R = sf_save(PLA->R);
-
-	/* compute the phase cube for this iteration */
-	PLA->phase = set_save(cube.fullset);
-	num = i;
-	for(j = last_output; j >= first_output; j--) {
-	    if (num % 2 == 0) {
-		ind = cube.first_part[cube.output] + j;
-		set_remove(PLA->phase, ind);
+    if (pool_threads() > 1 && ! debug && ! trace) {
+	opoall_parallel(PLA, first_output, last_output,
+	    bestphase, &best_F, &best_D, &best_R);
+    } else {
+	for(i = 0; i < POW2(last_output - first_output + 1); i++) {
+
+	    /* each phase starts afresh, as in opoall_parallel() */
+	    reduce_toggle = toggle;
+	    unwrap_onset = unwrap;
+
+	    /* save the initial PLA covers */
+	    F = sf_save(PLA->F);
+	    D = sf_save(PLA->D);
+	    R = sf_save(PLA->R);
+
+	    /* compute the phase cube for this iteration */
+	    PLA->phase = opoall_phase(i, first_output, last_output);
+
+	    /* set the phase and minimize */
+	    (void) set_phase(PLA);
+	    printf("# phase is %s\n", pc1(PLA->phase));
+	    summary = TRUE;
+	    minimize(PLA);
+
+	    /* see if this is the best so far */
+	    if (PLA->F->count < best_F->count) {
+		/* save new best solution */
+		set_copy(bestphase, PLA->phase);
+		sf_free(best_F);
+		sf_free(best_D);
+		sf_free(best_R);
+		best_F = PLA->F;
+		best_D = PLA->D;
+		best_R = PLA->R;
+	    } else {
+		/* throw away the solution */
+		free_cover(PLA->F);
+		free_cover(PLA->D);
+		free_cover(PLA->R);
 	    }
-	    num /= 2;
-	}
+	    set_free(PLA->phase);
 
-	/* set the phase and minimize */
-	(void) set_phase(PLA);
-	printf("# phase is %s\n", pc1(PLA->phase));
-	summary = TRUE;
-	minimize(PLA);
-
-	/* see if this is the best so far */
-	if (PLA->F->count < best_F->count) {
-	    /* save new best solution */
-	    set_copy(bestphase, PLA->phase);
-	    sf_free(best_F);
-	    sf_free(best_D);
-	    sf_free(best_R);
-	    best_F = PLA->F;
-	    best_D = PLA->D;
-	    best_R = PLA->R;
-	} else {
-	    /* throw away the solution */
-	    free_cover(PLA->F);
-	    free_cover(PLA->D);
-	    free_cover(PLA->R);
+	    /* restore the initial PLA covers */
+	    PLA->F = F;
+	    PLA->D = D;
+	    PLA->R = R;
 	}
-	set_free(PLA->phase);
-
-	/* restore the initial PLA covers */
-	PLA->F = F;
-	PLA->D = D;
-	PLA->R = R;
+	reduce_toggle = toggle;
+	unwrap_onset = unwrap;
     }
 
     /* one more minimization to restore the best answer */
@@ -582,7 +719,7 @@ void opoall(pPLA PLA, int first_output, int last_output, int opo_strategy)
     PLA->D = best_D;
     PLA->R = best_R;
 }
-
+
 void minimize(pPLA PLA)
 {
     if (opo_exact) {
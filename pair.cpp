@@ -122,8 +122,8 @@ pcover pairvar(pcover A, ppair pair)
 	for(pairnum = 0; pairnum < pair->cnt; pairnum++) {
 	    p1 = cube.first_part[pair->var1[pairnum] - 1];
 	    p2 = cube.first_part[pair->var2[pairnum] - 1];
-	    b1 = is_in_set(p, p2+1);
-	    b0 = is_in_set(p, p2);
+	    b1 = is_in_set(p, p2+1) != 0;
+	    b0 = is_in_set(p, p2) != 0;
 	    val = insert_col + pairnum * 4;
 	    if (/* a0 */ is_in_set(p, p1)) {
 		if (b0)
@@ -337,23 +337,24 @@ int **find_pairing_cost(pPLA PLA, int strategy)
     return cost_array;
 }
 
-static int best_cost;
-static int **cost_array;
-static ppair best_pair;
-static pset best_phase;
-static pPLA global_PLA;
-static pcover best_F, best_D, best_R;
-static int pair_minim_strategy;
+static THREAD_LOCAL int best_cost;
+static THREAD_LOCAL int **cost_array;
+static THREAD_LOCAL ppair best_pair;
+static THREAD_LOCAL pset best_phase;
+static THREAD_LOCAL pPLA global_PLA;
+static THREAD_LOCAL pcover best_F, best_D, best_R;
+static THREAD_LOCAL int pair_minim_strategy;
+static THREAD_LOCAL bool pair_toggle, pair_unwrap;	/* reduce_toggle, unwrap_onset */
 
 
 void print_pair(ppair pair)
 {
     int i;
 
-    printf("pair is");
+    *espresso_out << "pair is";
     for(i = 0; i < pair->cnt; i++)
-	printf (" (%d %d)", pair->var1[i], pair->var2[i]);
-    printf("\n");
+	*espresso_out << " (" << pair->var1[i] << " " << pair->var2[i] << ")";
+    *espresso_out << "\n";
 }
 
 
@@ -430,6 +431,173 @@ void find_best_cost(ppair pair)
     }
 }
 
+/*
+ *  pair_all_parallel -- pair_all() as a search on the thread pool
+ *
+ *  Each pairing is a candidate of a search (see search.c).  Pairing the
+ *  variables changes the cube structure, so each candidate is minimized
+ *  with a cube structure of its own; with the exact strategy it gives up
+ *  before the covering step when it cannot beat the best pairing so far.
+ */
+static THREAD_LOCAL std::vector<ppair> *pair_list;
+
+static void collect_pair(ppair pair)
+{
+    pair_list->push_back(pair_save(pair, pair->cnt));
+}
+
+struct pair_search {
+    psearch s;
+    pPLA PLA;
+    int strategy;
+    std::vector<ppair> *pairs;
+    int num_vars, num_binary_vars, *part_size;	/* the unpaired cube */
+};
+
+static void *pair_run(int i, void *arg)
+{
+    struct pair_search *all = (struct pair_search *) arg;
+    struct cube_struct cube_save = cube;	/* structure copy ! */
+    struct cdata_struct cdata_save = cdata;	/*      ""          */
+    struct set_vector_struct set_vector_save = set_vector;
+    struct cube_struct *origin_save = pool_origin;
+    ppair pair = (*all->pairs)[i];
+    pPLA PLA1;
+    pcover F;
+    int var;
+
+    PLA1 = new_PLA();
+    PLA1->F = sf_save(all->PLA->F);
+    PLA1->D = sf_save(all->PLA->D);
+    PLA1->R = sf_save(all->PLA->R);
+
+    /* a cube structure of our own, which set_pair1() may change */
+    cube.num_vars = all->num_vars;
+    cube.num_binary_vars = all->num_binary_vars;
+    cube.part_size = new int[cube.num_vars];
+    for(var = 0; var < cube.num_vars; var++)
+	cube.part_size[var] = all->part_size[var];
+    cube_setup();
+    pool_origin = NULL;
+
+    /* setup the paired variables */
+    PLA1->pair = pair_save(pair, pair->cnt);
+    set_pair1(PLA1, /* adjust_labels */ FALSE);
+
+    /* call the minimizer */
+    if (summary)
+	print_pair(pair);
+    switch(all->strategy) {
+	case 2:
+	    EXEC_S(phase_assignment(PLA1,0), "OPO       ", PLA1->F);
+	    if (summary)
+		*espresso_out << "# phase is " << pc1(PLA1->phase) << "\n";
+	    break;
+	case 1: {
+	    const auto t = ptime();
+	    F = minimize_exact_search(PLA1->F, PLA1->D, PLA1->R, 1, all->s, i);
+	    free_cover(PLA1->F);
+	    PLA1->F = F;
+	    if (F == NULL) {
+		if (summary)
+		    *espresso_out << "# EXACT     \tcannot beat the best pairing\n";
+		free_PLA(PLA1);
+		PLA1 = NULL;
+	    } else if (summary) {
+		print_trace(PLA1->F, "EXACT     ", ptime() - t);
+	    }
+	    break;
+	}
+	case 0: {
+	    const auto t = ptime();
+	    F = espresso_search(PLA1->F, PLA1->D, PLA1->R, all->s, i);
+	    PLA1->F = F;
+	    if (F == NULL) {
+		if (summary)
+		    *espresso_out << "# ESPRESSO  \tcannot beat the best pairing\n";
+		free_PLA(PLA1);
+		PLA1 = NULL;
+	    } else if (summary) {
+		print_trace(PLA1->F, "ESPRESSO  ", ptime() - t);
+	    }
+	    break;
+	}
+	default:
+	    break;
+    }
+    if (PLA1 != NULL)
+	search_better(all->s, i, PLA1->F->count);
+
+    /* back to the cube structure we had */
+    setdown_cube();
+    delete cube.part_size;
+    cube = cube_save;
+    cdata = cdata_save;
+    set_vector = set_vector_save;
+    pool_origin = origin_save;
+    return (void *) PLA1;
+}
+
+static void pair_done(int i, void *result, void *arg)
+{
+    pPLA PLA1 = (pPLA) result;
+
+    (void) i;
+    (void) arg;
+
+    /* see if we have a new best solution */
+    if (PLA1 == NULL) {
+	return;
+    }
+    if (PLA1->F->count < best_cost) {
+	best_cost = PLA1->F->count;
+	if (best_pair != NULL) pair_free(best_pair);
+	if (best_phase != NULL) set_free(best_phase);
+	if (best_F != NULL) sf_free(best_F);
+	if (best_D != NULL) sf_free(best_D);
+	if (best_R != NULL) sf_free(best_R);
+	best_pair = PLA1->pair;
+	best_phase = PLA1->phase;
+	best_F = PLA1->F;
+	best_D = PLA1->D;
+	best_R = PLA1->R;
+	PLA1->pair = NULL;
+	PLA1->phase = NULL;
+	PLA1->F = PLA1->D = PLA1->R = NULL;
+    }
+    free_PLA(PLA1);
+}
+
+static void pair_all_parallel(ppair pair, pset candidate)
+{
+    struct pair_search all;
+    search_t s;
+    int i;
+
+    pair_list = new std::vector<ppair>;
+    generate_all_pairs(pair, cube.num_binary_vars, candidate, collect_pair);
+
+    all.s = &s;
+    all.PLA = global_PLA;
+    all.strategy = pair_minim_strategy;
+    all.pairs = pair_list;
+    all.num_vars = cube.num_vars;
+    all.num_binary_vars = cube.num_binary_vars;
+    all.part_size = cube.part_size;
+
+    search_init(&s, pair_list->size());
+    s.run = pair_run;
+    s.done = pair_done;
+    s.arg = (void *) &all;
+    search_better(&s, -1, best_cost);
+    search_run(&s);
+
+    for(i = 0; i < (int) pair_list->size(); i++)
+	pair_free((*pair_list)[i]);
+    delete pair_list;
+    pair_list = NULL;
+}
+
 /*
     pair_all: brute-force approach to try all possible pairings
 
@@ -446,6 +614,8 @@ void pair_all(pPLA PLA, int pair_strategy)
 
     global_PLA = PLA;
     pair_minim_strategy = pair_strategy;
+    pair_toggle = reduce_toggle;
+    pair_unwrap = unwrap_onset;
     best_cost = PLA->F->count + 1;
     best_pair = NULL;
     best_phase = NULL;
@@ -453,7 +623,13 @@ void pair_all(pPLA PLA, int pair_strategy)
     pair = pair_new(cube.num_binary_vars);
     candidate = set_fill(set_new(cube.num_binary_vars), cube.num_binary_vars);
 
-    generate_all_pairs(pair, cube.num_binary_vars, candidate, minimize_pair);
+    if (pool_threads() > 1 && ! debug && ! trace) {
+	pair_all_parallel(pair, candidate);
+    } else {
+	generate_all_pairs(pair, cube.num_binary_vars, candidate, minimize_pair);
+	reduce_toggle = pair_toggle;
+	unwrap_onset = pair_unwrap;
+    }
 
     pair_free(pair);
     set_free(candidate);
@@ -501,7 +677,9 @@ void minimize_pair(ppair pair)
     global_PLA->pair = pair;
     set_pair1(global_PLA, /* adjust_labels */ FALSE);
 
-    /* call the minimizer */
+    /* call the minimizer; each pairing starts afresh, as in pair_run() */
+    reduce_toggle = pair_toggle;
+    unwrap_onset = pair_unwrap;
     if (summary)
 	print_pair(pair);
     switch(pair_minim_strategy) {
@@ -0,0 +1,250 @@
+/*
+    Module: pool.c -- a small work-stealing thread pool
+
+    pool_setup(n) starts n-1 threads which, together with the thread that
+    spawns the work, run the tasks handed out by the recursive algorithms
+    (e.g., tautology()).  Each thread has a queue of its own: pool_spawn()
+    adds a task to the back of the queue of the calling thread, the owner
+    takes tasks back from the same end (depth first), and an idle thread
+    steals from the front of someone else's queue (the largest pieces of
+    work).  Threads which are not part of the pool share queue 0.
+
+    pool_wait() keeps the waiting thread busy: it runs tasks until its
+    group is finished, so the recursion may go as deep as it likes with
+    a fixed number of threads.  A waiting thread only picks up tasks
+    spawned for the same cube structure as its own, so it never runs
+    work for another minimization; the threads of the pool install the
+    cube structure of each task with cube_share(), and its engine
+    options with engine_options_install().  When there is nothing it
+    may run, the waiting thread sleeps on pool_done until the last task
+    of its group finishes or another task is spawned.
+*/
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unistd.h>
+#include "espresso.h"
+
+struct pool_task {
+    void (*fn)(void *);
+    void *arg;
+    struct task_group *group;
+    struct cube_struct *origin;		/* cube structure of the spawner */
+    struct engine_options options;	/* engine options of the spawner */
+};
+
+struct pool_queue {
+    std::mutex lock;
+    std::deque<pool_task> tasks;
+};
+
+static int pool_nthreads = 1;
+static pool_queue *pool_queues = NULL;
+static std::vector<std::thread> pool_workers;
+static std::atomic<int> pool_queued(0);		/* tasks in all queues */
+static std::atomic<bool> pool_stop(false);
+static std::mutex pool_sleep_lock;
+static std::condition_variable pool_wakeup;
+static std::condition_variable pool_done;	/* for pool_wait() */
+static std::atomic<int> pool_waiting(0);	/* threads asleep in pool_wait() */
+static std::atomic<long> pool_spawned(0);	/* tasks queued so far */
+
+static THREAD_LOCAL int pool_index = 0;		/* queue of this thread */
+THREAD_LOCAL struct cube_struct *pool_origin = NULL;	/* see cube_share() */
+
+static struct cube_struct *current_origin()
+{
+    return pool_origin != NULL ? pool_origin : &cube;
+}
+
+/* take_task -- find a task for "origin" (NULL for any), own queue first */
+static bool take_task(struct cube_struct *origin, pool_task *t)
+{
+    int i, k;
+
+    if (pool_queued.load(std::memory_order_relaxed) == 0)
+	return FALSE;
+
+    for(i = 0; i < pool_nthreads; i++) {
+	k = (pool_index + i) % pool_nthreads;
+	pool_queue &q = pool_queues[k];
+	std::lock_guard<std::mutex> guard(q.lock);
+	if (q.tasks.empty())
+	    continue;
+	if (i == 0) {
+	    if (origin == NULL || q.tasks.back().origin == origin) {
+		*t = q.tasks.back();
+		q.tasks.pop_back();
+		pool_queued--;
+		return TRUE;
+	    }
+	} else {
+	    if (origin == NULL || q.tasks.front().origin == origin) {
+		*t = q.tasks.front();
+		q.tasks.pop_front();
+		pool_queued--;
+		return TRUE;
+	    }
+	}
+    }
+    return FALSE;
+}
+
+static void run_task(pool_task *t)
+{
+    struct cube_struct *save = pool_origin;
+    struct engine_options save_options;
+
+    if (t->origin != current_origin()) {
+	cube_share(t->origin);
+	pool_origin = t->origin;
+    }
+    engine_options_save(&save_options);
+    engine_options_install(&t->options);
+    (*t->fn)(t->arg);
+    engine_options_install(&save_options);
+    pool_origin = save;
+    if (t->group->pending.fetch_sub(1) == 1 && pool_waiting.load() > 0) {
+	{
+	    std::lock_guard<std::mutex> guard(pool_sleep_lock);
+	}
+	pool_done.notify_all();
+    }
+}
+
+static void pool_worker(int index)
+{
+    pool_task t;
+
+    pool_index = index;
+    pool_origin = NULL;
+    while (! pool_stop.load()) {
+	if (take_task((struct cube_struct *) NULL, &t)) {
+	    run_task(&t);
+	} else {
+	    std::unique_lock<std::mutex> guard(pool_sleep_lock);
+	    pool_wakeup.wait(guard, []{
+		return pool_stop.load() || pool_queued.load() > 0; });
+	}
+    }
+}
+
+/* pool_setup -- start the pool with "nthreads" threads (<= 0: all cores) */
+void pool_setup(int nthreads)
+{
+    static bool registered = FALSE;
+    int i;
+
+    pool_setdown();
+    if (! registered) {
+	(void) atexit(pool_setdown);		/* join the threads on exit() */
+	registered = TRUE;
+    }
+    if (nthreads <= 0)
+	nthreads = std::max((int) std::thread::hardware_concurrency(), 1);
+    pool_nthreads = nthreads;
+    pool_queues = new pool_queue[nthreads];
+    pool_stop = FALSE;
+    for(i = 1; i < nthreads; i++)
+	pool_workers.push_back(std::thread(pool_worker, i));
+}
+
+/* pool_setdown -- stop the threads of the pool */
+void pool_setdown()
+{
+    if (pool_queues == NULL)
+	return;
+    {
+	std::lock_guard<std::mutex> guard(pool_sleep_lock);
+	pool_stop = TRUE;
+    }
+    pool_wakeup.notify_all();
+    for(auto &w : pool_workers) {
+	if (w.get_id() == std::this_thread::get_id())
+	    w.detach();				/* exit() from a task */
+	else
+	    w.join();
+    }
+    pool_workers.clear();
+    delete [] pool_queues;
+    pool_queues = NULL;
+    pool_nthreads = 1;
+}
+
+/*
+    pool_exit -- exit(status) from any thread
+
+    A thread of the pool cannot run the exit handlers (they stop the pool
+    and free what the other threads are still using), so it flushes the
+    output and leaves with _exit() instead.
+*/
+void pool_exit(int status)
+{
+    if (pool_index == 0) {
+	exit(status);
+    }
+    std::cout.flush();
+    (void) fflush(stdout);
+    (void) fflush(stderr);
+    _exit(status);
+}
+
+/* pool_threads -- number of threads which run tasks (1 if no pool) */
+int pool_threads()
+{
+    return pool_nthreads;
+}
+
+/* pool_spawn -- queue fn(arg) as a task of "group" */
+void pool_spawn(struct task_group *group, void (*fn)(void *), void *arg)
+{
+    pool_task t;
+
+    t.fn = fn;
+    t.arg = arg;
+    t.group = group;
+    t.origin = current_origin();
+    group->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (pool_queues == NULL) {			/* no pool: run it now */
+	(*fn)(arg);
+	group->pending.fetch_sub(1, std::memory_order_relaxed);
+	return;
+    }
+    engine_options_save(&t.options);
+    {
+	pool_queue &q = pool_queues[pool_index];
+	std::lock_guard<std::mutex> guard(q.lock);
+	q.tasks.push_back(t);
+	pool_queued++;
+    }
+    pool_spawned++;
+    {
+	std::lock_guard<std::mutex> guard(pool_sleep_lock);
+    }
+    pool_wakeup.notify_one();
+    if (pool_waiting.load() > 0)
+	pool_done.notify_all();
+}
+
+/* pool_wait -- run tasks until all the tasks of "group" are finished */
+void pool_wait(struct task_group *group)
+{
+    pool_task t;
+    long spawned;
+
+    while (group->pending.load() > 0) {
+	spawned = pool_spawned.load();
+	if (take_task(current_origin(), &t)) {
+	    run_task(&t);
+	} else {
+	    std::unique_lock<std::mutex> guard(pool_sleep_lock);
+	    pool_waiting++;
+	    pool_done.wait(guard, [group, spawned]{
+		return group->pending.load() == 0 || pool_spawned.load() != spawned; });
+	    pool_waiting--;
+	}
+    }
+}
@@ -15,16 +15,16 @@ pcover primes_consensus(pcube * T /* T will be disposed of */)
     pcover Tnew, Tl, Tr;
 
     if (primes_consensus_special_cases(T, &Tnew) == MAYBE) {
-	cl = new_cube();
-	cr = new_cube();
+	cl = new_scratch_cube();
+	cr = new_scratch_cube();
 	best = binate_split_select(T, cl, cr, COMPL);
 
 	Tl = primes_consensus(scofactor(T, cl, best));
 	Tr = primes_consensus(scofactor(T, cr, best));
 	Tnew = primes_consensus_merge(Tl, Tr, cl, cr);
 
-	free_cube(cl);
-	free_cube(cr);
+	free_scratch_cube(cl);
+	free_scratch_cube(cr);
 	free_cubelist(T);
     }
 
@@ -64,25 +64,25 @@ pcover *Tnew			/* returned only if answer determined */)
     }
 
     /* Check for a column of all 0's which can be factored out */
-    ceil = set_save(cof);
+    ceil = set_copy(new_scratch_cube(), cof);
     for(T1 = T+2; (p = *T1++) != NULL; ) {
 	INLINEset_or(ceil, ceil, p);
     }
     if (! setp_equal(ceil, cube.fullset)) {
-	p = new_cube();
+	p = new_scratch_cube();
 	(void) set_diff(p, cube.fullset, ceil);
 	(void) set_or(cof, cof, p);
-	free_cube(p);
+	free_scratch_cube(p);
 
 	A = primes_consensus(T);
 	foreach_set(A, last, p) {
 	    INLINEset_and(p, p, ceil);
 	}
 	*Tnew = A;
-	set_free(ceil);
+	free_scratch_cube(ceil);
 	return TRUE;
     }
-    set_free(ceil);
+    free_scratch_cube(ceil);
 
     /* Collect column counts, determine unate variables, etc. */
     massive_count(T);
@@ -7,9 +7,21 @@
     cube while still maintaining a cover of the same logic function.
 */
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 #include "espresso.h"
 
-static bool toggle = TRUE;
+THREAD_LOCAL bool reduce_toggle = TRUE;	/* alternate the two cube orders */
+THREAD_LOCAL int reduce_mode = REDUCE_SEQUENTIAL;	/* -epreduce, -ejacobi */
+THREAD_LOCAL int pass_memo_mode = TRUE;	/* -efullpass turns it off */
+
+#define REDUCE_SPAWN_CUBES	64	/* smaller F are reduced in order */
+#define REDUCE_CHUNK_CUBES	4	/* cubes reduced by each task */
+
+static void reduce_pipeline(pcover F, pcover D, pcube *FD);
+static void reduce_jacobi(pcover F, pcube *FD);
+static void reduce_mark(pcube p, pcube cunder);
 
 
 /*
@@ -52,29 +64,21 @@ pcover reduce(pcover F, pcover D)
     if (use_random_order)
 	F = random_order(F);
     else {
-	F = toggle ? sort_reduce(F) : mini_sort(F, descend);
-	toggle = ! toggle;
+	F = reduce_toggle ? sort_reduce(F) : mini_sort(F, descend);
+	reduce_toggle = ! reduce_toggle;
     }
 
     /* Try to reduce each cube */
     FD = cube2list(F, D);
+    if (reduce_mode == REDUCE_JACOBI)
+	reduce_jacobi(F, FD);
+    else if (reduce_mode == REDUCE_PIPELINE && pool_threads() > 1 &&
+	    ! (debug & (REDUCE | REDUCE1)) && F->count >= REDUCE_SPAWN_CUBES)
+	reduce_pipeline(F, D, FD);
+    else
     foreach_set(F, last, p) {
 	cunder = reduce_cube(FD, p);		/* reduce the cube */
-	if (setp_equal(cunder, p)) {            /* see if it actually did */
-	    SET(p, ACTIVE);	/* cube remains active */
-	    SET(p, PRIME);	/* cube remains prime ? */
-	} else {
-	    if (debug & REDUCE) {
-		printf("REDUCE: %s to %s\n",
-		    pc1(p), pc2(cunder));
-	    }
-	    set_copy(p, cunder);                /* save reduced version */
-	    RESET(p, PRIME);                    /* cube is no longer prime */
-	    if (setp_empty(cunder))
-		RESET(p, ACTIVE);               /* if null, kill the cube */
-	    else
-		SET(p, ACTIVE);                 /* cube is active */
-	}
+	reduce_mark(p, cunder);
 	free_cube(cunder);
     }
     free_cubelist(FD);
@@ -83,13 +87,367 @@ pcover reduce(pcover F, pcover D)
     return sf_inactive(F);
 }
 
+/* reduce_mark -- replace p by its reduction cunder */
+static void reduce_mark(pcube p, pcube cunder)
+{
+    if (setp_equal(cunder, p)) {            /* see if it actually did */
+	SET(p, ACTIVE);		/* cube remains active */
+	SET(p, PRIME);		/* cube remains prime ? */
+    } else {
+	if (debug & REDUCE) {
+	    printf("REDUCE: %s to %s\n",
+		pc1(p), pc2(cunder));
+	}
+	set_copy(p, cunder);                /* save reduced version */
+	RESET(p, PRIME);                    /* cube is no longer prime */
+	if (setp_empty(cunder))
+	    RESET(p, ACTIVE);               /* if null, kill the cube */
+	else
+	    SET(p, ACTIVE);                 /* cube is active */
+    }
+}
+
+/*
+    Reduction on the thread pool
+
+    reduce_cube() reads the other cubes of FD only through their parts
+    inside p (cofactor() keeps the cubes which meet p, and sccc() reads a
+    cube q only as q | T[0], with T[0] outside p), so the reduction of p
+    computed against an earlier state of F is the one it would get now
+    if every cube reduced since then either missed p or kept the same
+    parts inside p.  The reductions are logged (the cube and its parts
+    before) for reduce_valid() to check this.
+
+    With -epreduce (REDUCE_PIPELINE) the cubes are reduced in batches of
+    REDUCE_CHUNK_CUBES per thread against a copy of F, the next batch is
+    started before the current one is committed, and the results are
+    committed in order; a cube whose result is out of date is reduced
+    again against F.  The cover is the one reduce() computes in order.
+
+    With -ejacobi (REDUCE_JACOBI) every cube is reduced against the cover
+    as it stands at the start of a round, all at once.  The results are
+    committed in order, and a cube whose result is out of date is not
+    reduced again but left for the next round, against the cover left by
+    this one.  The first cube of each round always commits, and each
+    commit keeps F a cover, as in reduce().  The cover does not depend on
+    the number of threads, but differs from the one reduce() computes in
+    order, since a cube left for a later round is reduced after the
+    cubes which follow it.
+*/
+
+struct reduce_change {
+    int k;				/* the cube of F */
+    pcube before;			/* its parts before */
+};
+
+struct reduce_chunk {
+    pcover F;				/* the cubes to reduce ... */
+    pcube *FD;				/* ... against this list */
+    int *index, n;
+    pcube *cunder;
+};
+
+static void reduce_chunk_run(void *arg)
+{
+    struct reduce_chunk *c = (struct reduce_chunk *) arg;
+    int i;
+
+    for(i = 0; i < c->n; i++)
+	c->cunder[i] = reduce_cube(c->FD, GETSET(c->F, c->index[i]));
+}
+
+/* reduce_spawn -- reduce the cubes 'index' of F against FD on the pool */
+static void reduce_spawn(struct task_group *group, std::vector<struct reduce_chunk>& chunk,
+    pcover F, pcube *FD, std::vector<int>& index, std::vector<pcube>& cunder)
+{
+    int i, n = index.size();
+
+    cunder.resize(n);
+    chunk.resize((n + REDUCE_CHUNK_CUBES - 1) / REDUCE_CHUNK_CUBES);
+    group->pending = 0;
+    for(i = 0; i < (int) chunk.size(); i++) {
+	chunk[i].F = F;
+	chunk[i].FD = FD;
+	chunk[i].index = &index[i * REDUCE_CHUNK_CUBES];
+	chunk[i].n = std::min(REDUCE_CHUNK_CUBES, n - i * REDUCE_CHUNK_CUBES);
+	chunk[i].cunder = &cunder[i * REDUCE_CHUNK_CUBES];
+	pool_spawn(group, reduce_chunk_run, &chunk[i]);
+    }
+}
+
+/* reduce_valid -- no cube of F changed inside p since log entry 'from' */
+static bool reduce_valid(pcover F, pcube p, std::vector<struct reduce_change>& log,
+    int from, pcube before, pcube after)
+{
+    int i;
+
+    for(i = from; i < (int) log.size(); i++)
+	if (cdist0(log[i].before, p)) {
+	    (void) set_and(before, log[i].before, p);
+	    (void) set_and(after, GETSET(F, log[i].k), p);
+	    if (! setp_equal(before, after))
+		return FALSE;
+	}
+    return TRUE;
+}
+
+/* reduce_commit -- reduce cube k of F to cunder, and log the change */
+static void reduce_commit(pcover F, int k, pcube cunder, std::vector<struct reduce_change>& log)
+{
+    pcube p = GETSET(F, k);
+    struct reduce_change change;
+
+    if (! setp_equal(cunder, p)) {
+	change.k = k;
+	change.before = set_save(p);
+	log.push_back(change);
+    }
+    reduce_mark(p, cunder);
+    free_cube(cunder);
+}
+
+struct reduce_batch {
+    pcover S;				/* F when the batch started */
+    pcube *FD;
+    std::vector<int> index;
+    std::vector<pcube> cunder;
+    std::vector<struct reduce_chunk> chunk;
+    int log;				/* the log entries already in S */
+    struct task_group group;
+};
+
+/* reduce_pipeline -- reduce() in order, a batch ahead on the pool */
+static void reduce_pipeline(pcover F, pcover D, pcube *FD)
+{
+    struct reduce_batch batch[2], *b, *next;
+    std::vector<struct reduce_change> log;
+    pcube before = new_cube(), after = new_cube();
+    int i, k, first, last, size = pool_threads() * REDUCE_CHUNK_CUBES;
+
+    for(first = 0; first < F->count; first += size) {
+	b = &batch[(first / size) % 2];
+	if (first == 0) {
+	    b->S = NULL;		/* F itself: nothing is committed yet */
+	    b->FD = FD;
+	    b->log = 0;
+	    for(k = 0; k < std::min(size, F->count); k++)
+		b->index.push_back(k);
+	    reduce_spawn(&b->group, b->chunk, F, FD, b->index, b->cunder);
+	}
+
+	/* Start the next batch against a copy of F as it is now */
+	if (first + size < F->count) {
+	    next = &batch[(first / size + 1) % 2];
+	    next->S = sf_save(F);
+	    next->FD = cube2list(next->S, D);
+	    next->log = log.size();
+	    next->index.clear();
+	    last = std::min(F->count, first + 2 * size);
+	    for(k = first + size; k < last; k++)
+		next->index.push_back(k);
+	    reduce_spawn(&next->group, next->chunk, next->S, next->FD,
+		next->index, next->cunder);
+	}
+
+	/* Commit this batch in order */
+	pool_wait(&b->group);
+	for(i = 0; i < (int) b->index.size(); i++) {
+	    k = b->index[i];
+	    if (! reduce_valid(F, GETSET(F, k), log, b->log, before, after)) {
+		free_cube(b->cunder[i]);
+		b->cunder[i] = reduce_cube(FD, GETSET(F, k));
+	    }
+	    reduce_commit(F, k, b->cunder[i], log);
+	}
+	if (b->S != NULL) {
+	    free_cubelist(b->FD);
+	    free_cover(b->S);
+	}
+    }
+
+    for(i = 0; i < (int) log.size(); i++)
+	free_cube(log[i].before);
+    free_cube(before);
+    free_cube(after);
+}
+
+/* reduce_jacobi -- reduce all cubes of F at once, in rounds */
+static void reduce_jacobi(pcover F, pcube *FD)
+{
+    std::vector<int> index, later;
+    std::vector<pcube> cunder;
+    std::vector<struct reduce_chunk> chunk;
+    std::vector<struct reduce_change> log;
+    struct task_group group;
+    pcube before = new_cube(), after = new_cube();
+    int i, k;
+
+    for(k = 0; k < F->count; k++)
+	index.push_back(k);
+    while (! index.empty()) {
+	reduce_spawn(&group, chunk, F, FD, index, cunder);
+	pool_wait(&group);
+
+	/* Commit in order what is still up to date */
+	later.clear();
+	for(i = 0; i < (int) index.size(); i++) {
+	    k = index[i];
+	    if (reduce_valid(F, GETSET(F, k), log, 0, before, after)) {
+		reduce_commit(F, k, cunder[i], log);
+	    } else {
+		free_cube(cunder[i]);
+		later.push_back(k);
+	    }
+	}
+	for(i = 0; i < (int) log.size(); i++)
+	    free_cube(log[i].before);
+	log.clear();
+	index.swap(later);
+    }
+    free_cube(before);
+    free_cube(after);
+}
+
+/*
+    The reductions found by reduce_cube() are kept per thread.  The
+    reduction of p reads the cubes of FD only through their parts inside
+    p, and the smallest cube containing the complement does not depend
+    on their order, so it is kept under p and those parts.  The key is
+    hashed without regard to the order, and the parts are only sorted to
+    check a match.  The later passes of espresso() and last_gasp() often
+    reduce a cube again among the same parts, and then sccc() is skipped.
+*/
+#define REDUCE_MEMO_BYTES	(16 << 20)	/* emptied when it grows past this */
+
+struct reduce_kept {
+    std::vector<set_word> words;	/* the reduction, p, then the parts */
+    bool sorted;			/* the parts are in order */
+};
+
+struct reduce_memo {
+    std::vector<int> part_size;		/* the cube structure */
+    std::unordered_map<unsigned long, struct reduce_kept> kept;
+    long bytes;
+    std::vector<set_word> part;		/* scratch: the parts of this call */
+    std::vector<int> order;
+};
+
+static THREAD_LOCAL struct reduce_memo *reduce_memo_current = NULL;
+
+/* reduce_forget -- drop the reductions kept by reduce_cube() */
+void reduce_forget()
+{
+    delete reduce_memo_current;
+    reduce_memo_current = NULL;
+}
+
+/* reduce_memo_for -- the memo of this thread for the current cube structure */
+static struct reduce_memo *reduce_memo_for()
+{
+    struct reduce_memo *memo = reduce_memo_current;
+    int var;
+
+    if (memo != NULL) {
+	bool same = memo->part_size.size() == (size_t) cube.num_vars;
+	for(var = 0; same && var < cube.num_vars; var++)
+	    same = memo->part_size[var] == cube.part_size[var];
+	if (! same)
+	    reduce_forget(), memo = NULL;
+    }
+    if (memo == NULL) {
+	memo = reduce_memo_current = new reduce_memo;
+	memo->part_size.assign(cube.part_size, cube.part_size + cube.num_vars);
+	memo->bytes = 0;
+    }
+    if (memo->bytes > REDUCE_MEMO_BYTES) {
+	memo->kept.clear();
+	memo->bytes = 0;
+    }
+    return memo;
+}
+
+static unsigned long reduce_hash(const set_word *a, int w)
+{
+    unsigned long h = 14695981039346656037UL;
+    int i;
+
+    for(i = 0; i < w; i++)
+	h = (h ^ a[i]) * 1099511628211UL;
+    h ^= h >> 31;
+    h *= 0x7fb5d329728ea185UL;
+    return h ^ (h >> 27);
+}
+
+/* reduce_sort -- sort the n parts of w words at a */
+static void reduce_sort(set_word *a, int n, int w, std::vector<int>& order)
+{
+    std::vector<set_word> copy(a, a + n*w);
+    int k;
+
+    order.resize(n);
+    for(k = 0; k < n; k++)
+	order[k] = k * w;
+    std::sort(order.begin(), order.end(), [&](int x, int y) {
+	return memcmp(&copy[x], &copy[y], w * sizeof(set_word)) < 0; });
+    for(k = 0; k < n; k++)
+	memcpy(a + k*w, &copy[order[k]], w * sizeof(set_word));
+}
+
 /* reduce_cube -- find the maximal reduction of a cube */
 pcube reduce_cube(pcube * FD, pcube p)
 {
-    pcube cunder;
+    pcube cunder, *T, *T1, q;
+    struct reduce_memo *memo;
+    unsigned long h;
+    int w = LOOP(p), i, n;
+
+    T = cofactor(FD, p);
+    if (! pass_memo_mode || (debug & REDUCE1)) {
+	cunder = sccc(T);
+	return set_and(cunder, cunder, p);
+    }
+
+    /* the parts inside p of the cubes which meet it */
+    memo = reduce_memo_for();
+    std::vector<set_word>& part = memo->part;
+    part.clear();
+    h = reduce_hash(p + 1, w);
+    for(T1 = T+2; (q = *T1++) != NULL; ) {
+	for(i = 1; i <= w; i++)
+	    part.push_back(q[i] & p[i]);
+	h += reduce_hash(&part[part.size() - w], w);
+    }
+    n = static_cast<int>(part.size()) / w;
+
+    auto it = memo->kept.find(h);
+    if (it != memo->kept.end()) {
+	struct reduce_kept& e = it->second;
+	if (e.words.size() == (size_t) (w + 1 + w + n*w) &&
+		memcmp(&e.words[w + 1], p + 1, w * sizeof(set_word)) == 0) {
+	    if (! e.sorted) {
+		reduce_sort(&e.words[2*w + 1], n, w, memo->order);
+		e.sorted = TRUE;
+	    }
+	    reduce_sort(part.data(), n, w, memo->order);
+	    if (memcmp(&e.words[2*w + 1], part.data(), n*w * sizeof(set_word)) == 0) {
+		free_cubelist(T);
+		cunder = new_cube();
+		memcpy(cunder, e.words.data(), (w + 1) * sizeof(set_word));
+		return cunder;
+	    }
+	}
+    }
 
-    cunder = sccc(cofactor(FD, p));
-    return set_and(cunder, cunder, p);
+    cunder = sccc(T);
+    (void) set_and(cunder, cunder, p);
+    struct reduce_kept& e = memo->kept[h];
+    memo->bytes -= static_cast<long>(e.words.size() * sizeof(set_word));
+    e.words.assign(cunder, cunder + w + 1);
+    e.words.insert(e.words.end(), p + 1, p + w + 1);
+    e.words.insert(e.words.end(), part.begin(), part.end());
+    e.sorted = FALSE;
+    memo->bytes += static_cast<long>(e.words.size() * sizeof(set_word));
+    return cunder;
 }
 
 
@@ -99,7 +457,7 @@ pcube sccc(pcube * T /* T will be disposed of */)
     pcube r;
     pcube cl, cr;
     int best;
-    static int sccc_level = 0;
+    static THREAD_LOCAL int sccc_level = 0;
 
     if (debug & REDUCE1) {
 	debug_print(T, "SCCC", sccc_level++);
@@ -0,0 +1,149 @@
+/*
+    Module: search.c -- a loop of independent minimizations on the pool
+
+    Several commands minimize a list of candidates one after the other and
+    keep the best (opoall(), pair_all()) or all (so_espresso()) of the
+    results.  search_run() runs the candidates as tasks of the pool and
+    hands the results back in candidate order, on the calling thread, as
+    the sequential loop
+
+	for(i = 0; i < s->n; i++)
+	    (*s->done)(i, (*s->run)(i, s->arg), s->arg);
+
+    would have produced them.  Each run gets the options of the calling
+    thread as they were when search_run() was called, and its progress
+    messages (espresso_out) are printed when its result is used.
+
+    The only state which espresso() passes from one call to the next is
+    the cube order of reduce() (reduce_toggle) and unwrap_onset, and each
+    run starts from the values they had when search_run() was called (so
+    does the sequential loop of each command), so the candidates are
+    independent and a run never has to be done twice.  run() may set up
+    a cube structure of its own, as long as it puts the old one back.
+
+    As in many_espresso(), at most 2*pool_threads() candidates are in
+    flight: the candidate after them is spawned only when the oldest one
+    has been handed to done(), so the results which are kept waiting
+    for an earlier candidate are bounded by the size of the pool, not by
+    the number of candidates.  Without a pool, each run is done as it is
+    spawned.  The tasks which a run spawns in turn (e.g., by tautology())
+    belong to the thread it runs on, not to the search, so a thread which
+    waits for them never takes up another candidate in the middle of its
+    own run.
+
+    A candidate which cannot beat the best one found so far may be given
+    up: run() reports the cost of its result with search_better(), and
+    returns NULL as soon as a lower bound on its cost fails
+    search_can_win() (minimize_exact_search() before its covering step,
+    espresso_search() after the essential primes).  Ties go to the
+    earlier candidate, as with the "<" of the sequential loop, so the
+    best candidate is the same no matter which runs were given up.
+*/
+
+#include <sstream>
+#include <deque>
+#include "espresso.h"
+
+/* the order of (cost, candidate); candidate -1 is the starting point */
+#define SEARCH_KEY(cost, i)	(((long long) (cost) << 32) | (long long) ((i) + 1))
+#define SEARCH_NONE		0x7fffffffffffffffLL
+
+struct search_job {
+    psearch s;
+    int i;				/* which candidate */
+    pcontext options;			/* options of the calling thread */
+    struct task_group group;
+    void *result;
+    std::ostringstream out;		/* what the run printed */
+};
+
+/* search_init -- a search over "n" candidates, nothing found yet */
+void search_init(psearch s, int n)
+{
+    s->n = n;
+    s->run = NULL;
+    s->done = NULL;
+    s->arg = NULL;
+    s->best = SEARCH_NONE;
+}
+
+/* search_better -- candidate "i" (-1: the starting point) costs "cost" */
+void search_better(psearch s, int i, int cost)
+{
+    long long key = SEARCH_KEY(cost, i), best = s->best.load();
+
+    while (key < best && ! s->best.compare_exchange_weak(best, key))
+	;
+}
+
+/* search_can_win -- may candidate "i" with cost >= "lower_bound" win ? */
+bool search_can_win(psearch s, int i, int lower_bound)
+{
+    return SEARCH_KEY(lower_bound, i) < s->best.load();
+}
+
+static void search_task(void *arg)
+{
+    struct search_job *job = (struct search_job *) arg;
+    struct cube_struct *origin_save = pool_origin;
+    std::ostream *out = espresso_out;
+    espresso_context_t save;
+
+    context_save(&save);
+    context_options(job->options);
+    espresso_out = &job->out;
+    pool_origin = NULL;			/* the run's own tasks, see above */
+    job->result = (*job->s->run)(job->i, job->s->arg);
+    pool_origin = origin_save;
+    context_options(&save);
+    espresso_out = out;
+}
+
+/* search_done -- wait for the oldest candidate in flight and hand it back */
+static void search_done(psearch s, std::deque<struct search_job *> *window,
+    struct cube_struct *origin)
+{
+    struct search_job *job = window->front();
+    struct cube_struct *origin_save = pool_origin;
+
+    pool_origin = origin;
+    pool_wait(&job->group);
+    pool_origin = origin_save;
+    *espresso_out << job->out.str();
+    (*s->done)(job->i, job->result, s->arg);
+    window->pop_front();
+    delete job;
+}
+
+/* search_run -- run the candidates of "s" in parallel, see above */
+void search_run(psearch s)
+{
+    std::deque<struct search_job *> window;
+    struct search_job *job;
+    struct cube_struct origin = cube;		/* structure copy ! */
+    struct cube_struct *task_origin, *origin_save = pool_origin;
+    espresso_context_t options;
+    int i;
+
+    /* lend the tasks a copy of the cube structure, which run() may change */
+    task_origin = pool_origin != NULL ? pool_origin : &origin;
+    context_save(&options);
+    for(i = 0; i < s->n; i++) {
+	job = new struct search_job;
+	job->s = s;
+	job->i = i;
+	job->options = &options;
+	job->result = NULL;
+	job->group.pending = 0;
+	pool_origin = task_origin;
+	pool_spawn(&job->group, search_task, (void *) job);
+	pool_origin = origin_save;
+	window.push_back(job);
+	if ((int) window.size() >= 2 * pool_threads()) {
+	    search_done(s, &window, task_origin);
+	}
+    }
+    while (! window.empty()) {
+	search_done(s, &window, task_origin);
+    }
+}
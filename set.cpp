@@ -4,10 +4,12 @@
 
 /* LINTLIBRARY */
 
+#include <climits>
+#include <sys/mman.h>
 #include "espresso.h"
-static pset_family set_family_garbage = NULL;
+static THREAD_LOCAL pset_family set_family_garbage = NULL;
 
-static void intcpy(unsigned int * d, unsigned int * s, long n)
+static void intcpy(set_word * d, set_word * s, long n)
 {
     int i;
     for(i = 0; i < n; i++) {
@@ -17,7 +19,7 @@ static void intcpy(unsigned int * d, unsigned int * s, long n)
 
 
 /* bit_index -- find first bit (from LSB) in a word (MSB=bit n, LSB=bit 0) */
-int bit_index(unsigned int a)
+int bit_index(set_word a)
 {
     int i;
     if (a == 0)
@@ -32,7 +34,7 @@ int bit_index(unsigned int a)
 int set_ord(pset a)
 {
     int i, sum = 0;
-    unsigned int val;
+    set_word val;
     for(i = LOOP(a); i > 0; i--)
 	if ((val = a[i]) != 0)
 	    sum += count_ones(val);
@@ -43,7 +45,7 @@ int set_ord(pset a)
 int set_dist(pset a, pset b)
 {
     int i, sum = 0;
-    unsigned int val;
+    set_word val;
     for(i = LOOP(a); i > 0; i--)
 	if ((val = a[i] & b[i]) != 0)
 	    sum += count_ones(val);
@@ -54,7 +56,8 @@ int set_dist(pset a, pset b)
 pset set_clear(pset r, int size)
 {
     int i = LOOPINIT(size);
-    *r = i; do r[i] = 0; while (--i > 0);
+    *r = i; PUTSIZE(r, 0);
+    do r[i] = 0; while (--i > 0);
     return r;
 }
 
@@ -62,11 +65,11 @@ pset set_clear(pset r, int size)
 pset set_fill(pset r, int size)
 {
     int i = LOOPINIT(size);
-    *r = i;
-    r[i] = ~ (unsigned) 0;
+    *r = i; PUTSIZE(r, 0);
+    r[i] = ~ (set_word) 0;
     r[i] >>= i * BPI - size;
     while (--i > 0)
-	r[i] = ~ (unsigned) 0;
+	r[i] = ~ (set_word) 0;
     return r;
 }
 
@@ -82,7 +85,12 @@ pset set_copy(pset r, pset a)
 pset set_and(pset r, pset a, pset b)
 {
     int i = LOOP(a);
-    PUTLOOP(r,i); do r[i] = a[i] & b[i]; while (--i > 0);
+    PUTLOOP(r,i);
+    if (i >= set_vector.words) {
+	(*set_vector.set_and)(r, a, b, i);
+	return r;
+    }
+    do r[i] = a[i] & b[i]; while (--i > 0);
     return r;
 }
 
@@ -90,7 +98,12 @@ pset set_and(pset r, pset a, pset b)
 pset set_or(pset r, pset a, pset b)
 {
     int i = LOOP(a);
-    PUTLOOP(r,i); do r[i] = a[i] | b[i]; while (--i > 0);
+    PUTLOOP(r,i);
+    if (i >= set_vector.words) {
+	(*set_vector.set_or)(r, a, b, i);
+	return r;
+    }
+    do r[i] = a[i] | b[i]; while (--i > 0);
     return r;
 }
 
@@ -98,7 +111,12 @@ pset set_or(pset r, pset a, pset b)
 pset set_diff(pset r, pset a, pset b)
 {
     int i = LOOP(a);
-    PUTLOOP(r,i); do r[i] = a[i] & ~b[i]; while (--i > 0);
+    PUTLOOP(r,i);
+    if (i >= set_vector.words) {
+	(*set_vector.set_diff)(r, a, b, i);
+	return r;
+    }
+    do r[i] = a[i] & ~b[i]; while (--i > 0);
     return r;
 }
 
@@ -126,7 +144,7 @@ pset set_merge(pset r, pset a, pset b, pset mask)
 bool set_andp(pset r, pset a, pset b)
 {
     int i = LOOP(a);
-    unsigned int x = 0;
+    set_word x = 0;
     PUTLOOP(r,i); do {r[i] = a[i] & b[i]; x |= r[i];} while (--i > 0);
     return x != 0;
 }
@@ -135,7 +153,7 @@ bool set_andp(pset r, pset a, pset b)
 bool set_orp(pset r, pset a, pset b)
 {
     int i = LOOP(a);
-    unsigned int x = 0;
+    set_word x = 0;
     PUTLOOP(r,i); do {r[i] = a[i] | b[i]; x |= r[i];} while (--i > 0);
     return x != 0;
 }
@@ -152,13 +170,13 @@ bool setp_empty(pset a)
 bool setp_full(pset a, int size)
 {
     int i = LOOP(a);
-    unsigned int test;
-    test = ~ (unsigned) 0;
+    set_word test;
+    test = ~ (set_word) 0;
     test >>= i * BPI - size;
     if (a[i] != test)
 	return FALSE;
     while (--i > 0)
-	if (a[i] != (~(unsigned) 0))
+	if (a[i] != (~(set_word) 0))
 	    return FALSE;
     return TRUE;
 }
@@ -167,6 +185,8 @@ bool setp_full(pset a, int size)
 bool setp_equal(pset a, pset b)
 {
     int i = LOOP(a);
+    if (i >= set_vector.words)
+	return (*set_vector.setp_equal)(a, b, i);
     do if (a[i] != b[i]) return FALSE; while (--i > 0);
     return TRUE;
 }
@@ -175,6 +195,8 @@ bool setp_equal(pset a, pset b)
 bool setp_disjoint(pset a, pset b)
 {
     int i = LOOP(a);
+    if (i >= set_vector.words)
+	return (*set_vector.setp_disjoint)(a, b, i);
     do if (a[i] & b[i]) return FALSE; while (--i > 0);
     return TRUE;
 }
@@ -183,6 +205,8 @@ bool setp_disjoint(pset a, pset b)
 bool setp_implies(pset a, pset b)
 {
     int i = LOOP(a);
+    if (i >= set_vector.words)
+	return (*set_vector.setp_implies)(a, b, i);
     do if (a[i] & ~b[i]) return FALSE; while (--i > 0);
     return TRUE;
 }
@@ -247,7 +271,7 @@ pset_family sf_copy(pset_family R, pset_family A)
     R->sf_size = A->sf_size;
     R->wsize = A->wsize;
 /*R->capacity = A->count;*/
-/*R->data = REALLOC(unsigned int, R->data, (long) R->capacity * R->wsize);*/
+/*R->data = REALLOC(set_word, R->data, (long) R->capacity * R->wsize);*/
     R->count = A->count;
     R->active_count = A->active_count;
     intcpy(R->data, A->data, (long) A->wsize * A->count);
@@ -272,18 +296,135 @@ pset_family sf_join(pset_family A, pset_family B)
 }
 
 
+/*
+ *  Storage for the sets of a family
+ *
+ *  The data of a family is a block of 2^k words; the first word of the
+ *  block records k (and whether the block was mapped), and the sets start
+ *  after it.  A family gets all the sets which fit into its block, so a
+ *  family which grows one set at a time (sf_addset()) moves to the next
+ *  class only when it doubles.  sf_free() keeps the block in a cache of
+ *  the thread which frees it, one list per class, from which the next
+ *  sf_new() of the same class is served: the espresso loop saves and
+ *  frees covers of the same few sizes over and over.
+ *
+ *  Blocks of SF_HUGE_CLASS and up are mapped with mmap() when -ehuge is
+ *  given, and the kernel is asked to back them with huge pages.
+ *
+ *  With -s, sf_print_stats() reports the peak size of the live blocks,
+ *  the number of live families and how many blocks came from the caches.
+ */
+#define SF_MIN_CLASS	4		/* 16 words */
+#define SF_CLASSES	48
+#define SF_HUGE_CLASS	(21 - LOGBPI + 3)	/* 2 MB */
+#define SF_MAPPED	0x100		/* flag in the first word */
+#define SF_CACHE_WORDS	(8L << 20)	/* words cached per thread */
+#define SF_NEXT(b)	(*(set_word **) ((b) + 2))
+
+struct sf_cache {
+    set_word *free[SF_CLASSES];		/* free blocks, linked by SF_NEXT */
+    long words;				/* words in the cache */
+};
+
+static THREAD_LOCAL struct sf_cache sf_cache;
+
+bool sf_keep_stats = FALSE;
+static std::atomic<long> sf_live_bytes(0), sf_peak_bytes(0);
+static std::atomic<long> sf_live_families(0), sf_blocks(0), sf_reused(0);
+
+static set_word *sf_block_new(int k)
+{
+    set_word *b;
+    size_t bytes = (size_t) sizeof(set_word) << k;
+    long live, peak;
+
+    if ((b = sf_cache.free[k]) != NULL) {
+	sf_cache.free[k] = SF_NEXT(b);
+	sf_cache.words -= 1L << k;
+	if (sf_keep_stats)
+	    sf_reused.fetch_add(1, std::memory_order_relaxed);
+    } else {
+#ifdef MAP_ANONYMOUS
+	if (use_huge_pages && k >= SF_HUGE_CLASS) {
+	    b = (set_word *) mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	    if (b == (set_word *) MAP_FAILED)
+		fatal("out of memory for a set family");
+#ifdef MADV_HUGEPAGE
+	    (void) madvise((void *) b, bytes, MADV_HUGEPAGE);
+#endif
+	    b[0] = k | SF_MAPPED;
+	} else
+#endif
+	{
+	    b = new set_word[1L << k];
+	    b[0] = k;
+	}
+    }
+
+    if (sf_keep_stats) {
+	sf_blocks.fetch_add(1, std::memory_order_relaxed);
+	live = sf_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	peak = sf_peak_bytes.load(std::memory_order_relaxed);
+	while (live > peak && ! sf_peak_bytes.compare_exchange_weak(peak, live))
+	    ;
+    }
+    return b;
+}
+
+static void sf_block_free(set_word *b)
+{
+    int k = b[0] & (SF_MAPPED - 1);
+
+    if (sf_keep_stats)
+	sf_live_bytes.fetch_sub((long) sizeof(set_word) << k,
+	    std::memory_order_relaxed);
+    if (sf_cache.words + (1L << k) <= SF_CACHE_WORDS) {
+	SF_NEXT(b) = sf_cache.free[k];
+	sf_cache.free[k] = b;
+	sf_cache.words += 1L << k;
+    } else if (b[0] & SF_MAPPED) {
+	(void) munmap((void *) b, (size_t) sizeof(set_word) << k);
+    } else {
+	delete [] b;
+    }
+}
+
+/* sf_data_new -- give A (of A->wsize) a block for at least "num" sets */
+static void sf_data_new(pset_family A, int num)
+{
+    int k;
+    long need = (long) num * A->wsize + 1, capacity;
+    set_word *b;
+
+    for(k = SF_MIN_CLASS; (1L << k) < need; k++)
+	;
+    b = sf_block_new(k);
+    capacity = ((1L << k) - 1) / A->wsize;
+    A->capacity = capacity > INT_MAX ? INT_MAX : (int) capacity;
+    A->data = b + 1;
+}
+
+/* sf_data_free -- give back the block of A */
+static void sf_data_free(pset_family A)
+{
+    sf_block_free(A->data - 1);
+}
+
+
 /* sf_append -- append the sets of B to the end of A, and dispose of B */
 pset_family sf_append(pset_family A, pset_family B)
 {
     long asize = A->count * A->wsize;
     long bsize = B->count * B->wsize;
+    set_word *old = A->data;
 
     if (A->sf_size != B->sf_size) fatal("sf_append: sf_size mismatch");
-    A->capacity = A->count + B->count;
-    const unsigned int* old = A->data;
-    A->data = new unsigned int[(long) A->capacity * A->wsize];
-    memcpy(A->data, old, asize * sizeof(unsigned int));
-    delete old;
+    if (A->count + B->count > A->capacity) {
+	sf_data_new(A, A->count + B->count);
+	memcpy(A->data, old, asize * sizeof(set_word));
+	sf_block_free(old - 1);
+    }
     intcpy(A->data + asize, B->data, bsize);
     A->count += B->count;
     A->active_count += B->active_count;
@@ -304,10 +445,11 @@ pset_family sf_new(int num, int size)
     }
     A->sf_size = size;
     A->wsize = SET_SIZE(size);
-    A->capacity = num;
-    A->data = new unsigned int[ (long) A->capacity * A->wsize];
+    sf_data_new(A, num);
     A->count = 0;
     A->active_count = 0;
+    if (sf_keep_stats)
+	sf_live_families.fetch_add(1, std::memory_order_relaxed);
     return A;
 }
 
@@ -322,21 +464,49 @@ pset_family sf_save(pset_family A)
 /* sf_free -- free the storage allocated for a set family */
 void sf_free(pset_family A)
 {
-    delete A->data;
+    sf_data_free(A);
     A->next = set_family_garbage;
     set_family_garbage = A;
+    if (sf_keep_stats)
+	sf_live_families.fetch_sub(1, std::memory_order_relaxed);
 }
 
 
-/* sf_cleanup -- free all of the set families from the garbage list */
+/* sf_cleanup -- free the unused set families and blocks of this thread */
 void sf_cleanup()
 {
     pset_family p, pnext;
+    set_word *b, *bnext;
+    int k;
+
     for(p = set_family_garbage; p != (pset_family) NULL; p = pnext) {
 	pnext = p->next;
 	delete p;
     }
     set_family_garbage = (pset_family) NULL;
+
+    for(k = 0; k < SF_CLASSES; k++) {
+	for(b = sf_cache.free[k]; b != NULL; b = bnext) {
+	    bnext = SF_NEXT(b);
+	    if (b[0] & SF_MAPPED)
+		(void) munmap((void *) b, (size_t) sizeof(set_word) << k);
+	    else
+		delete [] b;
+	}
+	sf_cache.free[k] = NULL;
+    }
+    sf_cache.words = 0;
+}
+
+
+/* sf_print_stats -- report on the storage of the set families (-s) */
+void sf_print_stats()
+{
+    long blocks = sf_blocks.load(), reused = sf_reused.load();
+
+    printf("# SET FAMILIES  peak %ld bytes, %ld live, %ld of %ld blocks reused (%.1f%%)\n",
+	sf_peak_bytes.load(), sf_live_families.load(), reused, blocks,
+	blocks > 0 ? 100.0 * reused / blocks : 0.0);
 }
 
 
@@ -345,18 +515,26 @@ pset_family sf_addset(pset_family A, pset s)
 {
     pset p;
 
-    if (A->count >= A->capacity) {
-	A->capacity = A->capacity + A->capacity/2 + 1;
-    const unsigned int* old = A->data;
-    A->data = new unsigned int[(long) A->capacity * A->wsize];
-    memcpy(A->data, old, A->count * A->wsize * sizeof(unsigned int));
-    delete old;
-    }
-    p = GETSET(A, A->count++);
+    p = sf_addroom(A);
+    A->count++;
     INLINEset_copy(p, s);
     return A;
 }
 
+/* sf_addroom -- the set after the last one of A, for the caller to fill in and count */
+pset sf_addroom(pset_family A)
+{
+    set_word *old;
+
+    if (A->count >= A->capacity) {
+	old = A->data;
+	sf_data_new(A, A->count + 1);
+	memcpy(A->data, old, A->count * A->wsize * sizeof(set_word));
+	sf_block_free(old - 1);
+    }
+    return GETSET(A, A->count);
+}
+
 /* sf_delset -- delete a set from a set family */
 void sf_delset(pset_family A, int i)
 {   (void) set_copy(GETSET(A,i), GETSET(A, --A->count));}
@@ -458,7 +636,7 @@ pset_family sf_bm_read(std::istream& fp)
 
 /* ps1 -- convert a set into a printable string */
 #define largest_string 120
-static char s1[largest_string];
+static THREAD_LOCAL char s1[largest_string];
 char *ps1(pset a)
 {
     int i, num, l, len = 0, n = NELEM(a);
@@ -502,7 +680,7 @@ void
 set_adjcnt(pset a, int * count, int weight)
 {
     int i, base;
-    unsigned int val;
+    set_word val;
 
     for(i = LOOP(a); i > 0; ) {
 	for(val = a[i], base = --i << LOGBPI; val != 0; base++, val >>= 1) {
@@ -520,7 +698,7 @@ int *sf_count(pset_family A)
 {
     pset p, last;
     int i, base, *count;
-    unsigned int val;
+    set_word val;
 
     count = new int[A->sf_size];
     for(i = A->sf_size - 1; i >= 0; i--) {
@@ -548,7 +726,7 @@ int *sf_count_restricted(pset_family A, pset r)
 {
     pset p;
     int i, base, *count;
-    unsigned int val;
+    set_word val;
     int weight;
     pset last;
 
@@ -640,13 +818,13 @@ pset_family sf_copy_col(pset_family dst, int dstcol, pset_family src, int srccol
 {
     pset last, p, pdest;
     int word_test, word_set;
-    unsigned int bit_set, bit_test;
+    set_word bit_set, bit_test;
 
     /* CHEAT! form these constants outside the loop */
     word_test = WHICH_WORD(srccol);
-    bit_test = 1 << WHICH_BIT(srccol);
+    bit_test = (set_word) 1 << WHICH_BIT(srccol);
     word_set = WHICH_WORD(dstcol);
-    bit_set = 1 << WHICH_BIT(dstcol);
+    bit_set = (set_word) 1 << WHICH_BIT(dstcol);
 
     pdest = dst->data;
     foreach_set(src, last, p) {
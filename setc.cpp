@@ -36,6 +36,9 @@
     cdist01     return distance, or 2 if distance exceeds 1
     consensus   compute consensus of two cubes distance 1 apart
     force_lower expand hack (for now), related to consensus
+
+    When the cube is wide enough, each of these hands over to the vector
+    version installed in set_vector by setv.c.
 */
 
 #include "espresso.h"
@@ -54,8 +57,11 @@ bool full_row(pcube p, pcube cof)
 
 bool cdist0(pcube a, pcube b)
 {
+    if (set_vector.cdist0 != NULL)
+	return (*set_vector.cdist0)(a, b);
+
  {  /* Check binary variables */
-    int w, last; unsigned int x;
+    int w, last; set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -96,8 +102,11 @@ int cdist01(pset a, pset b)
 {
     int dist = 0;
 
+    if (set_vector.cdist01 != NULL)
+	return (*set_vector.cdist01)(a, b);
+
  {  /* Check binary variables */
-    int w, last; unsigned int x;
+    int w, last; set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -140,8 +149,11 @@ int cdist(pset a, pset b)
 {
     int dist = 0;
 
+    if (set_vector.cdist != NULL)
+	return (*set_vector.cdist)(a, b);
+
  {  /* Check binary variables */
-    int w, last; unsigned int x;
+    int w, last; set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -178,9 +190,11 @@ int cdist(pset a, pset b)
 
 pset force_lower(pset xlower, pset a, pset b)
 {
+    if (set_vector.force_lower != NULL)
+	return (*set_vector.force_lower)(xlower, a, b);
 
  {  /* Check binary variables (if any) */
-    int w, last; unsigned int x;
+    int w, last; set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -227,10 +241,15 @@ pset force_lower(pset xlower, pset a, pset b)
 
 void consensus(pcube r, pcube a, pcube b)
 {
+    if (set_vector.consensus != NULL) {
+	(*set_vector.consensus)(r, a, b);
+	return;
+    }
+
     INLINEset_clear(r, cube.size);
 
  {  /* Check binary variables (if any) */
-    int w, last; unsigned int x;
+    int w, last; set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -249,7 +268,7 @@ void consensus(pcube r, pcube a, pcube b)
 
 
  {  /* Check the multiple-valued variables */
-    bool empty; int var; unsigned int x;
+    bool empty; int var; set_word x;
     int w, last; pcube mask;
     for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
 	mask = cube.var_mask[var];
@@ -276,7 +295,7 @@ int cactive(pcube a)
 
  {  /* Check binary variables */
     int w, last;
-    unsigned int x;
+    set_word x;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -327,7 +346,7 @@ bool ccommon(pcube a, pcube b, pcube cof)
  {  /* Check binary variables */
     int last;
     int w;
-    unsigned int x, y;
+    set_word x, y;
     if ((last = cube.inword) != -1) {
 
 	/* Check the partial word of binary variables */
@@ -433,7 +452,7 @@ int d1_order(const void * v1, const void * v2) {
     const pset * b = static_cast<const pset*>(v2);
     pset a1 = *a, b1 = *b, c1 = cube.temp[0];
     int i = LOOP(a1);
-    unsigned int x1, x2;
+    set_word x1, x2;
     do
 	if ((x1 = a1[i] | c1[i]) > (x2 = b1[i] | c1[i])) return -1;
 	else if (x1 < x2) return 1;
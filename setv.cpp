@@ -0,0 +1,690 @@
+/*
+    setv.c -- vectorized versions of the set and cube kernels
+
+    The word loops of set.c and setc.c look at one word at a time.  When
+    the host supports AVX2 (256 bits) or AVX-512 (512 bits) the routines
+    here look at a full vector of words per step:
+
+	- the binary variables use the same DISJOINT trick as setc.c,
+	  i.e. t = ~(x | x >> 1) & DISJOINT with x = a & b.  The shift
+	  is done on 64-bit lanes for both word sizes: the bit shifted
+	  across a 32-bit word boundary always lands on an odd bit,
+	  which DISJOINT masks out again;
+
+	- the multiple-valued variables are checked one block of words
+	  at a time (a block is a vector when the variable is at least
+	  that wide, and a single word otherwise).
+
+    set_vector_setup() is called by cube_setup() and installs the widest
+    implementation the CPU supports.  The INLINE macros and the set.c
+    routines hand over to the vector code only for sets of at least
+    set_vector.words words, and the cdist family only when the cube
+    itself is that wide; everything else keeps the scalar loops.  The
+    results are bit-for-bit the same as those of the scalar code.
+*/
+
+#include "espresso.h"
+
+#ifndef VECTOR_MIN_WORDS
+#define VECTOR_MIN_WORDS	0	/* 0: one full vector of words */
+#endif
+
+static const struct set_vector_struct scalar_only = {
+    0x7fffffff, 0,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL
+};
+
+THREAD_LOCAL struct set_vector_struct set_vector = {
+    0x7fffffff, 0,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL
+};
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && BPI != 16
+#define HAVE_SET_VECTOR
+#include <immintrin.h>
+
+#define W256	(256 / BPI)		/* words per AVX2 vector */
+#define W512	(512 / BPI)		/* words per AVX-512 vector */
+
+/*
+ *  AVX2 kernels
+ */
+
+#define L256(p)		_mm256_loadu_si256((const __m256i *) (p))
+#define S256(p, x)	_mm256_storeu_si256((__m256i *) (p), x)
+#define Z256(x)		_mm256_testz_si256(x, x)
+#define DISJOINT256	_mm256_set1_epi64x((long long) 0x5555555555555555ULL)
+/* ~(x | x >> 1) & DISJOINT */
+#define NULLVARS256(x)\
+    _mm256_andnot_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 1)), DISJOINT256)
+
+__attribute__((target("avx2")))
+static void and_avx2(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W256 - 1 <= n; i += W256)
+	S256(r+i, _mm256_and_si256(L256(a+i), L256(b+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] & b[i];
+}
+
+__attribute__((target("avx2")))
+static void or_avx2(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W256 - 1 <= n; i += W256)
+	S256(r+i, _mm256_or_si256(L256(a+i), L256(b+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] | b[i];
+}
+
+__attribute__((target("avx2")))
+static void diff_avx2(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W256 - 1 <= n; i += W256)
+	S256(r+i, _mm256_andnot_si256(L256(b+i), L256(a+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] & ~b[i];
+}
+
+__attribute__((target("avx2")))
+static bool implies_avx2(pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W256 - 1 <= n; i += W256)
+	if (! _mm256_testc_si256(L256(b+i), L256(a+i)))
+	    return FALSE;
+    for(; i <= n; i++)
+	if (a[i] & ~b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx2")))
+static bool disjoint_avx2(pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W256 - 1 <= n; i += W256)
+	if (! _mm256_testz_si256(L256(a+i), L256(b+i)))
+	    return FALSE;
+    for(; i <= n; i++)
+	if (a[i] & b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx2")))
+static bool equal_avx2(pset a, pset b, int n)
+{
+    int i = 1;
+    __m256i x;
+    for(; i + W256 - 1 <= n; i += W256) {
+	x = _mm256_xor_si256(L256(a+i), L256(b+i));
+	if (! Z256(x))
+	    return FALSE;
+    }
+    for(; i <= n; i++)
+	if (a[i] != b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+/* count the null binary variables in one vector (t from NULLVARS256) */
+__attribute__((target("avx2")))
+static int count256(__m256i t)
+{
+    set_word v[W256];
+    int i, sum = 0;
+    S256(v, t);
+    for(i = 0; i < W256; i++)
+	if (v[i])
+	    sum += count_ones(v[i]);
+    return sum;
+}
+
+/* does variable "var" have a part in a & b ? */
+__attribute__((target("avx2")))
+static bool mv_meets_avx2(pcube a, pcube b, int var)
+{
+    int w = cube.first_word[var], last = cube.last_word[var];
+    pcube mask = cube.var_mask[var];
+    for(; w + W256 - 1 <= last; w += W256)
+	if (! _mm256_testz_si256(_mm256_and_si256(L256(a+w), L256(b+w)),
+		L256(mask+w)))
+	    return TRUE;
+    for(; w <= last; w++)
+	if (a[w] & b[w] & mask[w])
+	    return TRUE;
+    return FALSE;
+}
+
+__attribute__((target("avx2")))
+static bool cdist0_avx2(pcube a, pcube b)
+{
+    int w, last, var;
+    set_word x;
+    __m256i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if (~(x | x >> 1) & cube.inmask)
+	    return FALSE;
+	for(w = 1; w + W256 <= last; w += W256) {
+	    v = _mm256_and_si256(L256(a+w), L256(b+w));
+	    if (! Z256(NULLVARS256(v)))
+		return FALSE;
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if (~(x | x >> 1) & DISJOINT)
+		return FALSE;
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx2(a, b, var))
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx2")))
+static int cdist01_avx2(pset a, pset b)
+{
+    int w, last, var, dist = 0;
+    set_word x;
+    __m256i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    if ((dist = count_ones(x)) > 1)
+		return 2;
+	for(w = 1; w + W256 <= last; w += W256) {
+	    v = _mm256_and_si256(L256(a+w), L256(b+w));
+	    v = NULLVARS256(v);
+	    if (! Z256(v))
+		if (dist == 1 || (dist += count256(v)) > 1)
+		    return 2;
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		if (dist == 1 || (dist += count_ones(x)) > 1)
+		    return 2;
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx2(a, b, var))
+	    if (++dist > 1)
+		return 2;
+    return dist;
+}
+
+__attribute__((target("avx2")))
+static int cdist_avx2(pset a, pset b)
+{
+    int w, last, var, dist = 0;
+    set_word x;
+    __m256i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    dist = count_ones(x);
+	for(w = 1; w + W256 <= last; w += W256) {
+	    v = _mm256_and_si256(L256(a+w), L256(b+w));
+	    v = NULLVARS256(v);
+	    if (! Z256(v))
+		dist += count256(v);
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		dist += count_ones(x);
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx2(a, b, var))
+	    dist++;
+    return dist;
+}
+
+__attribute__((target("avx2")))
+static pset force_lower_avx2(pset xlower, pset a, pset b)
+{
+    int w, last, var;
+    set_word x;
+    __m256i v, t;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    xlower[last] |= (x | (x << 1)) & a[last];
+	for(w = 1; w + W256 <= last; w += W256) {
+	    v = L256(a+w);
+	    t = NULLVARS256(_mm256_and_si256(v, L256(b+w)));
+	    if (! Z256(t)) {
+		t = _mm256_or_si256(t, _mm256_slli_epi64(t, 1));
+		S256(xlower+w, _mm256_or_si256(L256(xlower+w),
+		    _mm256_and_si256(t, v)));
+	    }
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		xlower[w] |= (x | (x << 1)) & a[w];
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx2(a, b, var)) {
+	    pcube mask = cube.var_mask[var];
+	    for(w = cube.first_word[var], last = cube.last_word[var]; w <= last; w++)
+		xlower[w] |= a[w] & mask[w];
+	}
+    return xlower;
+}
+
+__attribute__((target("avx2")))
+static void consensus_avx2(pcube r, pcube a, pcube b)
+{
+    int w, last, var;
+    set_word x;
+    __m256i v, t;
+
+    INLINEset_clear(r, cube.size);
+
+    if ((last = cube.inword) != -1) {
+	r[last] = x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    r[last] |= (x | (x << 1)) & (a[last] | b[last]);
+	for(w = 1; w + W256 <= last; w += W256) {
+	    v = _mm256_and_si256(L256(a+w), L256(b+w));
+	    t = NULLVARS256(v);
+	    if (! Z256(t)) {
+		t = _mm256_or_si256(t, _mm256_slli_epi64(t, 1));
+		v = _mm256_or_si256(v, _mm256_and_si256(t,
+		    _mm256_or_si256(L256(a+w), L256(b+w))));
+	    }
+	    S256(r+w, v);
+	}
+	for(; w < last; w++) {
+	    r[w] = x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		r[w] |= (x | (x << 1)) & (a[w] | b[w]);
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+	pcube mask = cube.var_mask[var];
+	bool empty = TRUE;
+	last = cube.last_word[var];
+	for(w = cube.first_word[var]; w <= last; w++)
+	    if ((x = a[w] & b[w] & mask[w]))
+		empty = FALSE, r[w] |= x;
+	if (empty)
+	    for(w = cube.first_word[var]; w <= last; w++)
+		r[w] |= mask[w] & (a[w] | b[w]);
+    }
+}
+
+
+/*
+ *  AVX-512 kernels
+ */
+
+#define L512(p)		_mm512_loadu_si512((const void *) (p))
+#define S512(p, x)	_mm512_storeu_si512((void *) (p), x)
+#define NZ512(x)	(_mm512_test_epi64_mask(x, x) != 0)
+#define DISJOINT512	_mm512_set1_epi64((long long) 0x5555555555555555ULL)
+
+/*
+ *  GCC builds _mm512_andnot_si512() and the unmasked shifts on
+ *  _mm512_undefined_epi32(), which -Wall reports as maybe uninitialized;
+ *  the ternary logic and the zero-masked shifts give the same results.
+ */
+#define ANDNOT512(x, y)	_mm512_ternarylogic_epi64(x, y, y, 0x0c)	/* ~x & y */
+#define SRLI512(x, k)	_mm512_maskz_srli_epi64((__mmask8) 0xff, x, k)
+#define SLLI512(x, k)	_mm512_maskz_slli_epi64((__mmask8) 0xff, x, k)
+
+/* ~(x | x >> 1) & DISJOINT */
+#define NULLVARS512(x)\
+    ANDNOT512(_mm512_or_si512(x, SRLI512(x, 1)), DISJOINT512)
+
+__attribute__((target("avx512f")))
+static void and_avx512(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	S512(r+i, _mm512_and_si512(L512(a+i), L512(b+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] & b[i];
+}
+
+__attribute__((target("avx512f")))
+static void or_avx512(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	S512(r+i, _mm512_or_si512(L512(a+i), L512(b+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] | b[i];
+}
+
+__attribute__((target("avx512f")))
+static void diff_avx512(pset r, pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	S512(r+i, ANDNOT512(L512(b+i), L512(a+i)));
+    for(; i <= n; i++)
+	r[i] = a[i] & ~b[i];
+}
+
+__attribute__((target("avx512f")))
+static bool implies_avx512(pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	if (NZ512(ANDNOT512(L512(b+i), L512(a+i))))
+	    return FALSE;
+    for(; i <= n; i++)
+	if (a[i] & ~b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx512f")))
+static bool disjoint_avx512(pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	if (_mm512_test_epi64_mask(L512(a+i), L512(b+i)) != 0)
+	    return FALSE;
+    for(; i <= n; i++)
+	if (a[i] & b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx512f")))
+static bool equal_avx512(pset a, pset b, int n)
+{
+    int i = 1;
+    for(; i + W512 - 1 <= n; i += W512)
+	if (_mm512_cmpneq_epi64_mask(L512(a+i), L512(b+i)) != 0)
+	    return FALSE;
+    for(; i <= n; i++)
+	if (a[i] != b[i])
+	    return FALSE;
+    return TRUE;
+}
+
+/* count the null binary variables in one vector (t from NULLVARS512) */
+__attribute__((target("avx512f")))
+static int count512(__m512i t)
+{
+    set_word v[W512];
+    int i, sum = 0;
+    S512(v, t);
+    for(i = 0; i < W512; i++)
+	if (v[i])
+	    sum += count_ones(v[i]);
+    return sum;
+}
+
+/* does variable "var" have a part in a & b ? */
+__attribute__((target("avx512f")))
+static bool mv_meets_avx512(pcube a, pcube b, int var)
+{
+    int w = cube.first_word[var], last = cube.last_word[var];
+    pcube mask = cube.var_mask[var];
+    for(; w + W512 - 1 <= last; w += W512)
+	if (_mm512_test_epi64_mask(_mm512_and_si512(L512(a+w), L512(b+w)),
+		L512(mask+w)) != 0)
+	    return TRUE;
+    for(; w <= last; w++)
+	if (a[w] & b[w] & mask[w])
+	    return TRUE;
+    return FALSE;
+}
+
+__attribute__((target("avx512f")))
+static bool cdist0_avx512(pcube a, pcube b)
+{
+    int w, last, var;
+    set_word x;
+    __m512i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if (~(x | x >> 1) & cube.inmask)
+	    return FALSE;
+	for(w = 1; w + W512 <= last; w += W512) {
+	    v = _mm512_and_si512(L512(a+w), L512(b+w));
+	    if (NZ512(NULLVARS512(v)))
+		return FALSE;
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if (~(x | x >> 1) & DISJOINT)
+		return FALSE;
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx512(a, b, var))
+	    return FALSE;
+    return TRUE;
+}
+
+__attribute__((target("avx512f")))
+static int cdist01_avx512(pset a, pset b)
+{
+    int w, last, var, dist = 0;
+    set_word x;
+    __m512i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    if ((dist = count_ones(x)) > 1)
+		return 2;
+	for(w = 1; w + W512 <= last; w += W512) {
+	    v = _mm512_and_si512(L512(a+w), L512(b+w));
+	    v = NULLVARS512(v);
+	    if (NZ512(v))
+		if (dist == 1 || (dist += count512(v)) > 1)
+		    return 2;
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		if (dist == 1 || (dist += count_ones(x)) > 1)
+		    return 2;
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx512(a, b, var))
+	    if (++dist > 1)
+		return 2;
+    return dist;
+}
+
+__attribute__((target("avx512f")))
+static int cdist_avx512(pset a, pset b)
+{
+    int w, last, var, dist = 0;
+    set_word x;
+    __m512i v;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    dist = count_ones(x);
+	for(w = 1; w + W512 <= last; w += W512) {
+	    v = _mm512_and_si512(L512(a+w), L512(b+w));
+	    v = NULLVARS512(v);
+	    if (NZ512(v))
+		dist += count512(v);
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		dist += count_ones(x);
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx512(a, b, var))
+	    dist++;
+    return dist;
+}
+
+__attribute__((target("avx512f")))
+static pset force_lower_avx512(pset xlower, pset a, pset b)
+{
+    int w, last, var;
+    set_word x;
+    __m512i v, t;
+
+    if ((last = cube.inword) != -1) {
+	x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    xlower[last] |= (x | (x << 1)) & a[last];
+	for(w = 1; w + W512 <= last; w += W512) {
+	    v = L512(a+w);
+	    t = NULLVARS512(_mm512_and_si512(v, L512(b+w)));
+	    if (NZ512(t)) {
+		t = _mm512_or_si512(t, SLLI512(t, 1));
+		S512(xlower+w, _mm512_or_si512(L512(xlower+w),
+		    _mm512_and_si512(t, v)));
+	    }
+	}
+	for(; w < last; w++) {
+	    x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		xlower[w] |= (x | (x << 1)) & a[w];
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++)
+	if (! mv_meets_avx512(a, b, var)) {
+	    pcube mask = cube.var_mask[var];
+	    for(w = cube.first_word[var], last = cube.last_word[var]; w <= last; w++)
+		xlower[w] |= a[w] & mask[w];
+	}
+    return xlower;
+}
+
+__attribute__((target("avx512f")))
+static void consensus_avx512(pcube r, pcube a, pcube b)
+{
+    int w, last, var;
+    set_word x;
+    __m512i v, t;
+
+    INLINEset_clear(r, cube.size);
+
+    if ((last = cube.inword) != -1) {
+	r[last] = x = a[last] & b[last];
+	if ((x = ~(x | x >> 1) & cube.inmask))
+	    r[last] |= (x | (x << 1)) & (a[last] | b[last]);
+	for(w = 1; w + W512 <= last; w += W512) {
+	    v = _mm512_and_si512(L512(a+w), L512(b+w));
+	    t = NULLVARS512(v);
+	    if (NZ512(t)) {
+		t = _mm512_or_si512(t, SLLI512(t, 1));
+		v = _mm512_or_si512(v, _mm512_and_si512(t,
+		    _mm512_or_si512(L512(a+w), L512(b+w))));
+	    }
+	    S512(r+w, v);
+	}
+	for(; w < last; w++) {
+	    r[w] = x = a[w] & b[w];
+	    if ((x = ~(x | x >> 1) & DISJOINT))
+		r[w] |= (x | (x << 1)) & (a[w] | b[w]);
+	}
+    }
+
+    for(var = cube.num_binary_vars; var < cube.num_vars; var++) {
+	pcube mask = cube.var_mask[var];
+	bool empty = TRUE;
+	last = cube.last_word[var];
+	for(w = cube.first_word[var]; w <= last; w++)
+	    if ((x = a[w] & b[w] & mask[w]))
+		empty = FALSE, r[w] |= x;
+	if (empty)
+	    for(w = cube.first_word[var]; w <= last; w++)
+		r[w] |= mask[w] & (a[w] | b[w]);
+    }
+}
+
+#endif /* HAVE_SET_VECTOR */
+
+
+/*
+ *  set_vector_setup -- select the vector kernels for the current cube
+ *
+ *  The set operations are installed whenever the CPU supports them (they
+ *  are used for any long set, e.g. the rows of a covering table); the
+ *  cube operations are installed only when the cube itself is long
+ *  enough for the vector loop to pay off.
+ */
+void set_vector_setup()
+{
+    set_vector = scalar_only;
+
+#ifdef HAVE_SET_VECTOR
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+	set_vector.bits = 512;
+	set_vector.words = W512;
+	set_vector.set_and = and_avx512;
+	set_vector.set_or = or_avx512;
+	set_vector.set_diff = diff_avx512;
+	set_vector.setp_implies = implies_avx512;
+	set_vector.setp_disjoint = disjoint_avx512;
+	set_vector.setp_equal = equal_avx512;
+	set_vector.cdist0 = cdist0_avx512;
+	set_vector.cdist01 = cdist01_avx512;
+	set_vector.cdist = cdist_avx512;
+	set_vector.force_lower = force_lower_avx512;
+	set_vector.consensus = consensus_avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+	set_vector.bits = 256;
+	set_vector.words = W256;
+	set_vector.set_and = and_avx2;
+	set_vector.set_or = or_avx2;
+	set_vector.set_diff = diff_avx2;
+	set_vector.setp_implies = implies_avx2;
+	set_vector.setp_disjoint = disjoint_avx2;
+	set_vector.setp_equal = equal_avx2;
+	set_vector.cdist0 = cdist0_avx2;
+	set_vector.cdist01 = cdist01_avx2;
+	set_vector.cdist = cdist_avx2;
+	set_vector.force_lower = force_lower_avx2;
+	set_vector.consensus = consensus_avx2;
+    } else {
+	return;
+    }
+
+    if (VECTOR_MIN_WORDS > 0)
+	set_vector.words = VECTOR_MIN_WORDS;
+
+    /* narrow cubes are faster with the scalar loops of setc.c */
+    if (LOOPINIT(cube.size) < set_vector.words) {
+	set_vector.cdist0 = NULL;
+	set_vector.cdist01 = NULL;
+	set_vector.cdist = NULL;
+	set_vector.force_lower = NULL;
+	set_vector.consensus = NULL;
+    }
+#endif
+}
@@ -28,7 +28,7 @@ get_sigma(pcover R, pcube c)
 	pcube r,b;
 	int i;
     int w, last;
-	unsigned int x;
+	set_word x;
 
 	out_part_r = new_cube();
 	s = new_cube();
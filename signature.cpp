@@ -79,7 +79,7 @@ generate_primes(pcover F, pcover R)
 	pcube odd,even,out_part_r;
 	int i;
     int w, last;
-	unsigned int x;
+	set_word x;
 	int count;
 
 	out_part_r = new_cube();
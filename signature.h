@@ -1,4 +1,7 @@
-#if BPI == 16
+#if BPI == 64
+#define ODD_MASK 0xaaaaaaaaaaaaaaaaULL
+#define EVEN_MASK 0x5555555555555555ULL
+#elif BPI == 16
 #define ODD_MASK 0xaaaa
 #define EVEN_MASK 0x5555
 #else
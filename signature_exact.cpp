@@ -24,6 +24,7 @@ signature_minimize_exact(pcover ESCubes, pcover ESSet)
 	pcover COVER;
 	int index;
 	int *weights,heur,level;
+	mincov_outcome_t *outcome;
 
 	/* number ESCubes, ESSet */	
 	foreachi_set(ESCubes,index,p){
@@ -40,6 +41,12 @@ signature_minimize_exact(pcover ESCubes, pcover ESSet)
 	weights = nullptr; heur = FALSE; level = 0;
 	S_EXECUTE(cover=sm_minimum_cover(table,weights,heur,level), 
 		MINCOV_TIME);
+	outcome = sm_minimum_cover_outcome();
+	if (! outcome->complete) {
+		*espresso_out << "# signature: budget spent after " <<
+		    outcome->nodes << " nodes, cover cost " << outcome->cost <<
+		    ", lower bound " << outcome->lower_bound << "\n";
+	}
 
 	/* form the cover */
 	COVER = new_cover(100);
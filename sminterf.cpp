@@ -9,7 +9,7 @@ do_sm_minimum_cover(pset_family A)
     sm_element *pe;
     pset cover;
     int i, base, rownum;
-    unsigned val;
+    set_word val;
     pset last, p;
 
     M = sm_alloc();
@@ -0,0 +1,11 @@
+#ifndef THREADLOCAL_H
+#define THREADLOCAL_H
+
+/* Storage class for the per-thread state (cube, cdata, ...) */
+#ifdef __GNUC__
+#define THREAD_LOCAL	__thread
+#else
+#define THREAD_LOCAL	thread_local
+#endif
+
+#endif
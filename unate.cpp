@@ -11,7 +11,8 @@ static int abs_select_restricted(pset_family A, pset restrict);
 
 pcover map_cover_to_unate(pcube * T)
 {
-    unsigned int word_test, word_set, bit_test, bit_set;
+    int word_test, word_set;
+    set_word bit_test, bit_set;
     pcube p, pA;
     pset_family A;
     pcube *T1;
@@ -30,9 +31,9 @@ pcover map_cover_to_unate(pcube * T)
 
 	    /* Copy a column from T to A */
 	    word_test = WHICH_WORD(i);
-	    bit_test = 1 << WHICH_BIT(i);
+	    bit_test = (set_word) 1 << WHICH_BIT(i);
 	    word_set = WHICH_WORD(ncol);
-	    bit_set = 1 << WHICH_BIT(ncol);
+	    bit_set = (set_word) 1 << WHICH_BIT(ncol);
 
 	    pA = A->data;
 	    for(T1 = T+2; (p = *T1++) != 0; ) {
@@ -116,7 +116,7 @@ time_usage(char * name)
 void
 s_totals(const std::chrono::time_point<std::chrono::high_resolution_clock>& time, int i)
 {
-    total_time[i] += (ptime() - time);
+    total_time[i] += std::chrono::duration<double>(ptime() - time).count();
     total_calls[i]++;
 }
 
@@ -1,6 +1,8 @@
 /*
  */
 
+#include <algorithm>
+#include <atomic>
 #include "espresso.h"
 
 /*
@@ -9,32 +11,143 @@
  */
 bool verify(pcover F, pcover Fold, pcover Dold)
 {
-    pcube p, last, *FD;
+    pcube *FD;
     bool verify_error = FALSE;
 
     /* Make sure the function didn't grow too large */
     FD = cube2list(Fold, Dold);
-    foreach_set(F, last, p)
-	if (! cube_is_covered(FD, p)) {
-	    printf("some minterm in F is not covered by Fold u Dold\n");
-	    verify_error = TRUE;
-	    if (verbose_debug) printf("%s\n", pc1(p)); else break;
-	}
+    if (! verify_cover(F, FD, "some minterm in F is not covered by Fold u Dold"))
+	verify_error = TRUE;
     free_cubelist(FD);
 
     /* Make sure minimized function covers the original function */
     FD = cube2list(F, Dold);
-    foreach_set(Fold, last, p)
-	if (! cube_is_covered(FD, p)) {
-	    printf("some minterm in Fold is not covered by F u Dold\n");
-	    verify_error = TRUE;
-	    if (verbose_debug) printf("%s\n", pc1(p)); else break;
-	}
+    if (! verify_cover(Fold, FD, "some minterm in Fold is not covered by F u Dold"))
+	verify_error = TRUE;
     free_cubelist(FD);
 
     return verify_error;
 }
 
+/*
+ *  verify_cover -- check that every cube of A is covered by FD
+ *
+ *  The cubes of A are checked in batches of VERIFY_TASK_CUBES, as tasks
+ *  of the pool with -jN; the tasks share FD read-only.  Without -v the
+ *  check stops at the first cube of A (in order) which is not covered:
+ *  a batch skips the cubes after the least failure found so far, so
+ *  every cube before it has been checked and the cube reported is the
+ *  same as with -j1.  A minterm of the cube which FD misses is printed
+ *  along with the message; with -v every uncovered cube is printed.
+ */
+#define VERIFY_TASK_CUBES	8
+
+struct verify_task {
+    pcube *FD;
+    pcover A;
+    int first, last;			/* cubes first..last-1 of A */
+    bool all;				/* check every cube (-v) */
+    char *covered;
+    std::atomic<int> *failed;		/* least cube not covered, or A->count */
+};
+
+static void verify_run(void *arg)
+{
+    struct verify_task *task = (struct verify_task *) arg;
+    int i, least;
+
+    for(i = task->first; i < task->last; i++) {
+	if (! task->all && i > task->failed->load(std::memory_order_relaxed))
+	    break;
+	task->covered[i] = cube_is_covered(task->FD, GETSET(task->A, i));
+	if (! task->covered[i]) {
+	    least = task->failed->load(std::memory_order_relaxed);
+	    while (i < least && ! task->failed->compare_exchange_weak(least, i))
+		;
+	}
+    }
+}
+
+bool verify_cover(pcover A, pcube *FD, const char *message)
+{
+    struct verify_task *tasks;
+    struct task_group group;
+    std::atomic<int> failed(A->count);
+    char *covered;
+    pcube m;
+    int i, ntasks;
+    bool all = verbose_debug;		/* per thread, so not read by the tasks */
+
+    covered = new char[A->count + 1];
+    memset(covered, 1, A->count + 1);
+    ntasks = (A->count + VERIFY_TASK_CUBES - 1) / VERIFY_TASK_CUBES;
+    tasks = new struct verify_task[ntasks + 1];
+    group.pending = 0;
+    for(i = 0; i < ntasks; i++) {
+	tasks[i].FD = FD;
+	tasks[i].A = A;
+	tasks[i].first = i * VERIFY_TASK_CUBES;
+	tasks[i].last = std::min(A->count, (i + 1) * VERIFY_TASK_CUBES);
+	tasks[i].all = all;
+	tasks[i].covered = covered;
+	tasks[i].failed = &failed;
+	pool_spawn(&group, verify_run, (void *) &tasks[i]);
+    }
+    pool_wait(&group);
+
+    m = new_cube();
+    for(i = 0; i < A->count; i++) {
+	if (! covered[i]) {
+	    printf("%s\n", message);
+	    if (verify_minterm(FD, GETSET(A, i), m))
+		printf("counterexample: %s\n", pc1(m));
+	    if (all) printf("%s\n", pc1(GETSET(A, i))); else break;
+	}
+    }
+    free_cube(m);
+
+    delete [] tasks;
+    delete [] covered;
+    return failed == A->count;
+}
+
+/*
+ *  verify_minterm -- a minterm of c which is not covered by FD
+ *
+ *  Within c, FD covers exactly what its cofactor against c covers, so
+ *  any cube of the complement of the cofactor which meets c leads to a
+ *  minterm (the first part of each variable).  Returns FALSE if FD
+ *  covers c after all.
+ */
+bool verify_minterm(pcube *FD, pcube c, pcube m)
+{
+    pcover R;
+    pcube p, last;
+    int var, i;
+    bool found = FALSE;
+
+    R = complement(cofactor(FD, c));
+    foreach_set(R, last, p) {
+	if (cdist0(p, c)) {
+	    (void) set_and(m, p, c);
+	    found = TRUE;
+	    break;
+	}
+    }
+    free_cover(R);
+    if (! found)
+	return FALSE;
+
+    for(var = 0; var < cube.num_vars; var++) {
+	for(i = cube.first_part[var]; i <= cube.last_part[var]; i++)
+	    if (is_in_set(m, i))
+		break;
+	(void) set_diff(m, m, cube.var_mask[var]);
+	set_insert(m, i);
+    }
+    return TRUE;
+}
+
 
 
 /*